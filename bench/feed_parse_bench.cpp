@@ -0,0 +1,123 @@
+// Response handling on the feed/search path: JSON parsing, the statistics cache and the smart sort.
+// Build with -DYOUCPP_BUILD_BENCHMARKS=ON and run ./feed_parse_bench --benchmark_out=feed.json
+#include "../src/backend/YouTubeService.h"
+#include <benchmark/benchmark.h>
+#include <QTimeZone>
+#include <random>
+
+namespace {
+
+// Fixed clock so ages (and therefore the sort) are identical between builds
+QDateTime benchNow() {
+    return QDateTime(QDate(2025, 1, 1), QTime(12, 0), QTimeZone::utc());
+}
+
+QString videoId(int i) {
+    return QString("v%1").arg(i, 10, 10, QChar('0'));
+}
+
+QJsonObject snippet(int i, std::mt19937 &rng) {
+    QJsonObject medium{{"url", QString("https://i.ytimg.com/vi/%1/mqdefault.jpg").arg(videoId(i))}};
+    QJsonObject obj;
+    obj["title"] = QString("Synthetic video number %1 with a typical-length title").arg(i);
+    obj["channelTitle"] = QString("Channel %1").arg(rng() % 500);
+    obj["channelId"] = QString("UC%1").arg(rng() % 500, 22, 10, QChar('0'));
+    obj["publishedAt"] = benchNow().addSecs(-qint64(rng() % (90 * 24 * 3600))).toString(Qt::ISODate);
+    obj["description"] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.";
+    obj["thumbnails"] = QJsonObject{{"medium", medium}};
+    return obj;
+}
+
+// search.list shape: id is an object
+QByteArray searchResponse(int count) {
+    std::mt19937 rng(count);
+    QJsonArray items;
+    for (int i = 0; i < count; ++i) {
+        items.append(QJsonObject{{"kind", "youtube#searchResult"},
+                                 {"id", QJsonObject{{"kind", "youtube#video"}, {"videoId", videoId(i)}}},
+                                 {"snippet", snippet(i, rng)}});
+    }
+    return QJsonDocument(QJsonObject{{"items", items}}).toJson(QJsonDocument::Compact);
+}
+
+// videos.list?part=statistics,contentDetails, in reverse order so the cache can't rely on position
+QJsonDocument statisticsResponse(int count) {
+    std::mt19937 rng(count + 1);
+    QJsonArray items;
+    for (int i = count - 1; i >= 0; --i) {
+        QJsonObject statistics{{"viewCount", QString::number(rng() % 5000000)},
+                               {"likeCount", QString::number(rng() % 100000)}};
+        items.append(QJsonObject{{"id", videoId(i)},
+                                 {"statistics", statistics},
+                                 {"contentDetails", QJsonObject{{"duration", "PT12M34S"}}}});
+    }
+    return QJsonDocument(QJsonObject{{"items", items}});
+}
+
+void BM_ParseSearchResponse(benchmark::State &state) {
+    QByteArray json = searchResponse(state.range(0));
+    for (auto _ : state) {
+        QList<VideoResult> results = YouTubeService::parseVideosFromJson(QJsonDocument::fromJson(json));
+        benchmark::DoNotOptimize(results);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+
+QStringList videoIds(int count) {
+    QStringList ids;
+    for (int i = 0; i < count; ++i) ids.append(videoId(i));
+    return ids;
+}
+
+// Storing a videos.list response (what every statistics batch reply does)
+void BM_StatsCacheInsert(benchmark::State &state) {
+    const QJsonDocument stats = statisticsResponse(state.range(0));
+    const QStringList ids = videoIds(state.range(0));
+    for (auto _ : state) {
+        VideoStatsCache cache;
+        cache.insert(stats, ids, benchNow());
+        benchmark::DoNotOptimize(cache);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Copying cached statistics onto a freshly parsed page or feed, all hits
+void BM_StatsCacheApply(benchmark::State &state) {
+    const QList<VideoResult> videos = YouTubeService::parseVideosFromJson(
+        QJsonDocument::fromJson(searchResponse(state.range(0))));
+    VideoStatsCache cache;
+    cache.insert(statisticsResponse(state.range(0)), videoIds(state.range(0)), benchNow());
+    for (auto _ : state) {
+        QList<VideoResult> enriched = videos;
+        QStringList missing = cache.apply(enriched, benchNow());
+        benchmark::DoNotOptimize(enriched);
+        benchmark::DoNotOptimize(missing);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_SmartSort(benchmark::State &state) {
+    QList<VideoResult> videos = YouTubeService::parseVideosFromJson(
+        QJsonDocument::fromJson(searchResponse(state.range(0))));
+    VideoStatsCache cache;
+    cache.insert(statisticsResponse(state.range(0)), videoIds(state.range(0)), benchNow());
+    cache.apply(videos, benchNow());
+    const QDateTime now = benchNow();
+    for (auto _ : state) {
+        QList<VideoResult> sorted = videos;
+        YouTubeService::sortBySmartScore(sorted, now);
+        benchmark::DoNotOptimize(sorted);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(BM_ParseSearchResponse)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+// Up to VideoStatsCache::MAX_ENTRIES; 50 is one videos.list batch
+BENCHMARK(BM_StatsCacheInsert)->Arg(50)->Arg(1000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StatsCacheApply)->Arg(50)->Arg(1000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SmartSort)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,177 @@
+// Query latency of the on-disk transcript index at library scale (10k videos). Query benchmarks
+// report over_budget = 1 when a query takes longer than QUERY_BUDGET_MS on average, and the run
+// exits non-zero if any of them does.
+// Build with -DYOUCPP_BUILD_BENCHMARKS=ON and run ./transcript_index_bench
+#include "../src/backend/TranscriptIndex.h"
+#include <benchmark/benchmark.h>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int VIDEO_COUNT = 10000;
+const int SEGMENTS_PER_VIDEO = 200;
+const int WORDS_PER_SEGMENT = 7;
+const int VOCABULARY = 50000;
+// The index's target for any query over the 10k-video library
+const double QUERY_BUDGET_MS = 10.0;
+
+// Mean query time of each benchmark's last (reported) run
+std::map<std::string, double> g_queryMs;
+
+void checkBudget(benchmark::State &state, const QElapsedTimer &timer) {
+    double meanMs = timer.nsecsElapsed() / 1e6 / std::max<benchmark::IterationCount>(1, state.iterations());
+    g_queryMs[state.name()] = meanMs;
+    state.counters["over_budget"] = meanMs > QUERY_BUDGET_MS ? 1 : 0;
+}
+
+// Spoken text is roughly Zipfian: rank 0 is as common as "the", the tail shows up a handful of times
+class Vocabulary {
+public:
+    Vocabulary() {
+        double total = 0;
+        m_cdf.reserve(VOCABULARY);
+        for (int rank = 1; rank <= VOCABULARY; ++rank) {
+            total += 1.0 / rank;
+            m_cdf.push_back(total);
+        }
+        for (double &value : m_cdf) value /= total;
+    }
+
+    int sample(std::mt19937 &rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return std::min<int>(std::lower_bound(m_cdf.begin(), m_cdf.end(), u) - m_cdf.begin(), VOCABULARY - 1);
+    }
+
+    static QString word(int rank) { return QString("w%1").arg(rank); }
+
+private:
+    std::vector<double> m_cdf;
+};
+
+QByteArray vttTimestamp(qint64 ms) {
+    return QString("%1:%2:%3.%4")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+        .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+        .arg(ms % 1000, 3, 10, QChar('0'))
+        .toUtf8();
+}
+
+Transcript syntheticTranscript(const Vocabulary &vocabulary, std::mt19937 &rng) {
+    QByteArray vtt = "WEBVTT\n\n";
+    for (int s = 0; s < SEGMENTS_PER_VIDEO; ++s) {
+        qint64 start = s * 3000;
+        vtt += vttTimestamp(start) + " --> " + vttTimestamp(start + 3000) + "\n";
+        for (int w = 0; w < WORDS_PER_SEGMENT; ++w) {
+            vtt += Vocabulary::word(vocabulary.sample(rng)).toUtf8() + ' ';
+        }
+        vtt += "\n\n";
+    }
+    return Transcript::parse(vtt);
+}
+
+struct LibraryFixture {
+    QTemporaryDir dir;
+    std::unique_ptr<TranscriptIndex> index;
+
+    LibraryFixture() {
+        Vocabulary vocabulary;
+        std::mt19937 rng(42);
+        {
+            TranscriptIndex builder(dir.path());
+            for (int v = 0; v < VIDEO_COUNT; ++v) {
+                builder.add(QString("video%1").arg(v), QString("Video %1").arg(v), syntheticTranscript(vocabulary, rng));
+            }
+        }
+        // Queries run against a freshly opened index: mapped segments only, no delta
+        index = std::make_unique<TranscriptIndex>(dir.path());
+    }
+};
+
+LibraryFixture &library() {
+    static LibraryFixture fixture;
+    return fixture;
+}
+
+void BM_SingleTerm(benchmark::State &state) {
+    TranscriptIndex &index = *library().index;
+    QString query = Vocabulary::word(state.range(0));
+    size_t hits = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto _ : state) {
+        auto result = index.search(query);
+        hits = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    checkBudget(state, timer);
+    state.counters["hits"] = hits;
+}
+// Most common word, mid-frequency, rare
+BENCHMARK(BM_SingleTerm)->Arg(0)->Arg(100)->Arg(5000)->Arg(40000)->Unit(benchmark::kMicrosecond);
+
+void BM_AllTerms(benchmark::State &state) {
+    TranscriptIndex &index = *library().index;
+    QString query = Vocabulary::word(state.range(0)) + " " + Vocabulary::word(state.range(1));
+    size_t hits = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto _ : state) {
+        auto result = index.search(query);
+        hits = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    checkBudget(state, timer);
+    state.counters["hits"] = hits;
+}
+BENCHMARK(BM_AllTerms)->Args({0, 1})->Args({0, 500})->Args({100, 5000})->Unit(benchmark::kMicrosecond);
+
+void BM_OpenIndex(benchmark::State &state) {
+    QString path = library().dir.path();
+    for (auto _ : state) {
+        TranscriptIndex index(path);
+        benchmark::DoNotOptimize(index.documentCount());
+    }
+}
+BENCHMARK(BM_OpenIndex)->Unit(benchmark::kMillisecond);
+
+void BM_AddTranscript(benchmark::State &state) {
+    QTemporaryDir dir;
+    TranscriptIndex index(dir.path());
+    Vocabulary vocabulary;
+    std::mt19937 rng(7);
+    int next = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Transcript transcript = syntheticTranscript(vocabulary, rng);
+        state.ResumeTiming();
+        index.add(QString("added%1").arg(next++), QString(), transcript);
+    }
+}
+// Includes a segment flush every FLUSH_DOCS videos and the occasional merge
+BENCHMARK(BM_AddTranscript)->Unit(benchmark::kMicrosecond);
+
+}
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    bool overBudget = false;
+    for (const auto &[name, ms] : g_queryMs) {
+        if (ms <= QUERY_BUDGET_MS) continue;
+        fprintf(stderr, "%s: %.2f ms per query, budget is %.0f ms\n", name.c_str(), ms, QUERY_BUDGET_MS);
+        overBudget = true;
+    }
+    return overBudget ? 1 : 0;
+}
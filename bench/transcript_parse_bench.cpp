@@ -0,0 +1,114 @@
+// Caption parsing and in-video search on the fixtures in bench/fixtures/captions (WebVTT with
+// rolling auto-generated cues, srv1 timed text with double-escaped entities, srv3 with word
+// spans). The same files can be served to the app with YOUCPP_CAPTION_DIR. The parsed fixtures
+// are checked before anything is timed; a mismatch exits non-zero.
+// Build with -DYOUCPP_BUILD_BENCHMARKS=ON and run ./transcript_parse_bench
+#include "../src/backend/Transcript.h"
+#include <benchmark/benchmark.h>
+#include <QFile>
+#include <cstdio>
+
+namespace {
+
+const char *const FIXTURES[] = {"sample.vtt", "sample.xml", "sample-srv3.xml"};
+
+QByteArray readFixture(const char *name) {
+    QFile file(QString(YOUCPP_CAPTION_FIXTURES) + '/' + name);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+struct Expected {
+    const char *fixture;
+    int segments;
+    int segment;
+    qint64 startMs;
+    const char *text;
+};
+
+// Rolled-over VTT lines appear once; entities are decoded exactly once per format
+const Expected EXPECTED[] = {
+    {"sample.vtt", 3, 0, 0, "welcome back to the channel"},
+    {"sample.vtt", 3, 1, 2510, "today we benchmark AT&T routers"},
+    {"sample.vtt", 3, 2, 5010, "and the community says &lt;3 for fast caption search"},
+    {"sample.xml", 3, 1, 2600, "it's time to benchmark caption parsing"},
+    {"sample.xml", 3, 2, 5600, "don't forget to subscribe"},
+    {"sample-srv3.xml", 2, 0, 0, "welcome back to the channel"},
+    {"sample-srv3.xml", 2, 1, 2400, "srv3 splits words into spans"},
+};
+
+struct ExpectedSearch {
+    const char *fixture;
+    const char *query;
+    QVector<int> segments;
+};
+
+const ExpectedSearch EXPECTED_SEARCHES[] = {
+    {"sample.vtt", "benchmark rout", {1}},
+    {"sample.vtt", "channel", {0}},
+    {"sample.xml", "caption pars", {1}},
+    {"sample.xml", "dont", {2}},
+    {"sample-srv3.xml", "spans", {1}},
+    {"sample-srv3.xml", "welcome", {0}},
+};
+
+bool checkFixtures() {
+    bool ok = true;
+    for (const Expected &e : EXPECTED) {
+        Transcript transcript = Transcript::parse(readFixture(e.fixture));
+        if (transcript.size() != e.segments) {
+            fprintf(stderr, "%s: %d segments, expected %d\n", e.fixture, transcript.size(), e.segments);
+            ok = false;
+            continue;
+        }
+        if (transcript.startMs(e.segment) != e.startMs || transcript.text(e.segment) != QString(e.text)) {
+            fprintf(stderr, "%s[%d]: %lld \"%s\", expected %lld \"%s\"\n", e.fixture, e.segment,
+                    transcript.startMs(e.segment), transcript.text(e.segment).toUtf8().constData(),
+                    e.startMs, e.text);
+            ok = false;
+        }
+    }
+    for (const ExpectedSearch &e : EXPECTED_SEARCHES) {
+        QVector<int> hits = Transcript::parse(readFixture(e.fixture)).search(e.query);
+        if (hits != e.segments) {
+            fprintf(stderr, "%s: search \"%s\" gave %lld hits\n", e.fixture, e.query, qint64(hits.size()));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void BM_ParseFixture(benchmark::State &state) {
+    const char *name = FIXTURES[state.range(0)];
+    QByteArray data = readFixture(name);
+    state.SetLabel(name);
+    for (auto _ : state) {
+        Transcript transcript = Transcript::parse(data);
+        benchmark::DoNotOptimize(transcript);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_SearchFixture(benchmark::State &state) {
+    const char *name = FIXTURES[state.range(0)];
+    Transcript transcript = Transcript::parse(readFixture(name));
+    state.SetLabel(name);
+    for (auto _ : state) {
+        QVector<int> hits = transcript.search("welcome cha");
+        benchmark::DoNotOptimize(hits);
+    }
+}
+
+}
+
+BENCHMARK(BM_ParseFixture)->DenseRange(0, 2);
+BENCHMARK(BM_SearchFixture)->DenseRange(0, 2);
+
+int main(int argc, char **argv) {
+    if (!checkFixtures()) return 1;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
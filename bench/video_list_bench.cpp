@@ -0,0 +1,71 @@
+// Cost of showing a result list: MainWindow builds one VideoCard per result when search results
+// arrive. Runs on the offscreen platform; settings and caches go to QStandardPaths test locations.
+// Build with -DYOUCPP_BUILD_BENCHMARKS=ON and run ./video_list_bench --benchmark_out=list.json
+#include "../src/ui/MainWindow.h"
+#include <benchmark/benchmark.h>
+#include <QApplication>
+#include <QStandardPaths>
+
+namespace {
+
+YouTubeService *g_service = nullptr;
+
+QList<VideoResult> syntheticResults(int count) {
+    QList<VideoResult> results;
+    results.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        VideoResult vid;
+        vid.id = QString("v%1").arg(i, 10, 10, QChar('0'));
+        vid.title = QString("Synthetic video number %1 with a typical-length title").arg(i);
+        vid.channel = QString("Channel %1").arg(i % 500);
+        vid.channelId = QString("UC%1").arg(i % 500, 22, 10, QChar('0'));
+        vid.publishedAt = "2025-01-01T12:00:00Z";
+        // No thumbnail URL: the request fails locally instead of measuring the network
+        results.append(vid);
+    }
+    return results;
+}
+
+// searchResultsReady -> handleSearchResults -> populateVideoList, then the layout pass and the
+// deferred deletes of the previous cards, so each iteration pays for a full replace
+void BM_PopulateVideoList(benchmark::State &state) {
+    const QList<VideoResult> results = syntheticResults(state.range(0));
+    for (auto _ : state) {
+        emit g_service->searchResultsReady(results);
+        QCoreApplication::processEvents();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    emit g_service->searchResultsReady({});
+    QCoreApplication::processEvents();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+}
+
+BENCHMARK(BM_PopulateVideoList)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    QStandardPaths::setTestModeEnabled(true);
+
+    QApplication app(argc, argv);
+    app.setOrganizationName("YouCpp");
+    app.setApplicationName("YouCppBench");
+
+    g_service = new YouTubeService;
+    MainWindow window(new GoogleAuth, g_service);
+    window.resize(1280, 800);
+    window.show();
+    QCoreApplication::processEvents();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
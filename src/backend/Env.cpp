@@ -0,0 +1,28 @@
+#include "Env.h"
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+void loadEnv() {
+    QString envPath = ".env";
+    if (!QFile::exists(envPath)) {
+        envPath = "../.env"; 
+    }
+
+    QFile file(envPath);
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+
+            QStringList parts = line.split('=');
+            if (parts.size() >= 2) {
+                QString key = parts[0].trimmed();
+                QString value = parts[1].trimmed().remove('"').remove('\'');
+                qputenv(key.toUtf8(), value.toUtf8());
+            }
+        }
+        file.close();
+    }
+}
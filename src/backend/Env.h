@@ -0,0 +1,4 @@
+#pragma once
+
+// Reads KEY=value lines from ./.env (or ../.env when run from build/) into the process environment
+void loadEnv();
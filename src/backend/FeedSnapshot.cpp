@@ -0,0 +1,79 @@
+#include "FeedSnapshot.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+QString FeedSnapshot::filePath() {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return dir + "/feed-snapshot.json";
+}
+
+QList<VideoResult> FeedSnapshot::load() {
+    QList<VideoResult> results;
+
+    QFile file(filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return results;
+    }
+
+    QJsonArray items = QJsonDocument::fromJson(file.readAll()).object()["items"].toArray();
+    results.reserve(items.size());
+    for (const auto &item : items) {
+        QJsonObject obj = item.toObject();
+        VideoResult vid;
+        vid.id = obj["id"].toString();
+        vid.title = obj["title"].toString();
+        vid.channel = obj["channel"].toString();
+        vid.channelId = obj["channelId"].toString();
+        vid.thumbnailUrl = obj["thumbnailUrl"].toString();
+        vid.publishedAt = obj["publishedAt"].toString();
+        vid.viewCount = obj["viewCount"].toString().toULongLong();
+        vid.likeCount = obj["likeCount"].toString().toULongLong();
+        vid.duration = obj["duration"].toString();
+
+        if (!vid.id.isEmpty()) {
+            results.append(vid);
+        }
+    }
+
+    return results;
+}
+
+void FeedSnapshot::save(const QList<VideoResult> &results) {
+    QJsonArray items;
+    for (const auto &vid : results) {
+        QJsonObject obj;
+        obj["id"] = vid.id;
+        obj["title"] = vid.title;
+        obj["channel"] = vid.channel;
+        obj["channelId"] = vid.channelId;
+        obj["thumbnailUrl"] = vid.thumbnailUrl;
+        obj["publishedAt"] = vid.publishedAt;
+        // 64-bit counts don't survive a round trip through a JSON double
+        obj["viewCount"] = QString::number(vid.viewCount);
+        obj["likeCount"] = QString::number(vid.likeCount);
+        obj["duration"] = vid.duration;
+        items.append(obj);
+    }
+
+    QJsonObject root;
+    root["items"] = items;
+
+    QString path = filePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
+void FeedSnapshot::clear() {
+    QFile::remove(filePath());
+}
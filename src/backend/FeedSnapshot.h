@@ -0,0 +1,15 @@
+#pragma once
+#include <QList>
+#include <QString>
+#include "YouTubeService.h"
+
+// Last subscription feed kept on disk so startup can paint cards before the network answers
+class FeedSnapshot {
+public:
+    static QList<VideoResult> load();
+    static void save(const QList<VideoResult> &results);
+    static void clear();
+
+private:
+    static QString filePath();
+};
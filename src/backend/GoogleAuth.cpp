@@ -1,6 +1,7 @@
 #include "GoogleAuth.h"
+#include "Log.h"
+#include "Metrics.h"
 #include <QRegularExpression>
-#include <QDesktopServices>
 #include <QUrl>
 #include <QUrlQuery>
 #include <QTcpSocket>
@@ -8,18 +9,25 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QCoreApplication>
+#include <algorithm>
 
 const QString GoogleAuth::AUTH_URL = "https://accounts.google.com/o/oauth2/v2/auth";
 const QString GoogleAuth::TOKEN_URL = "https://oauth2.googleapis.com/token";
 const QString GoogleAuth::SCOPE = "https://www.googleapis.com/auth/youtube.readonly";
+const int GoogleAuth::REFRESH_MARGIN_SECS = 120;
+const int GoogleAuth::REFRESH_RETRY_MSECS = 60 * 1000;
 
 GoogleAuth::GoogleAuth(QObject *parent) 
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
     , m_callbackServer(new QTcpServer(this))
+    , m_refreshTimer(new QTimer(this))
 {
     connect(m_callbackServer, &QTcpServer::newConnection, 
             this, &GoogleAuth::handleNewConnection);
+
+    m_refreshTimer->setSingleShot(true);
+    connect(m_refreshTimer, &QTimer::timeout, this, &GoogleAuth::refreshAccessToken);
     
     loadTokens();
 }
@@ -33,6 +41,15 @@ GoogleAuth::~GoogleAuth() {
 void GoogleAuth::setCredentials(const QString &clientId, const QString &clientSecret) {
     m_clientId = clientId;
     m_clientSecret = clientSecret;
+
+    // Stored tokens are loaded before credentials exist, so the startup refresh happens here
+    if (m_refreshToken.isEmpty()) return;
+
+    if (m_accessToken.isEmpty() || isTokenExpired()) {
+        refreshAccessToken();
+    } else {
+        scheduleRefresh();
+    }
 }
 
 void GoogleAuth::startLogin() {
@@ -58,8 +75,8 @@ void GoogleAuth::startLogin() {
     query.addQueryItem("prompt", "consent");
     authUrl.setQuery(query);
     
-    // Open system browser
-    QDesktopServices::openUrl(authUrl);
+    // The UI opens it in the system browser; headless callers print it
+    emit authorizationUrlReady(authUrl);
 }
 
 void GoogleAuth::handleNewConnection() {
@@ -122,6 +139,7 @@ void GoogleAuth::exchangeCodeForToken(const QString &code) {
     postData.addQueryItem("grant_type", "authorization_code");
     
     QNetworkReply *reply = m_networkManager->post(request, postData.toString(QUrl::FullyEncoded).toUtf8());
+    Metrics::trackReply(reply);
     
     connect(reply, &QNetworkReply::finished, [this, reply]() {
         reply->deleteLater();
@@ -134,26 +152,34 @@ void GoogleAuth::exchangeCodeForToken(const QString &code) {
         QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
         QJsonObject obj = doc.object();
         
-        m_accessToken = obj["access_token"].toString();
-        m_refreshToken = obj["refresh_token"].toString();
-        
-        if (m_accessToken.isEmpty()) {
+        if (obj["access_token"].toString().isEmpty()) {
             emit authenticationFailed("No access token in response");
             return;
         }
-        
+
+        applyTokenResponse(obj);
         saveTokens();
+        scheduleRefresh();
         emit authenticated();
     });
 }
 
 void GoogleAuth::logout() {
+    m_refreshTimer->stop();
+    if (m_refreshReply) {
+        QNetworkReply *reply = m_refreshReply;
+        m_refreshReply = nullptr;
+        reply->abort();
+    }
+
     m_accessToken.clear();
     m_refreshToken.clear();
+    m_expiresAt = QDateTime();
     
     QSettings settings("YouCpp", "YouCpp");
     settings.remove("auth/accessToken");
     settings.remove("auth/refreshToken");
+    settings.remove("auth/expiresAt");
     
     emit loggedOut();
 }
@@ -166,26 +192,64 @@ QString GoogleAuth::accessToken() const {
     return m_accessToken;
 }
 
+QDateTime GoogleAuth::expiresAt() const {
+    return m_expiresAt;
+}
+
+bool GoogleAuth::isTokenExpired() const {
+    // Tokens saved before expiry was tracked have no timestamp; let the API decide
+    if (!m_expiresAt.isValid()) return false;
+    return QDateTime::currentDateTimeUtc().secsTo(m_expiresAt) <= REFRESH_MARGIN_SECS;
+}
+
+bool GoogleAuth::isRefreshing() const {
+    return m_refreshReply != nullptr;
+}
+
 void GoogleAuth::loadTokens() {
     QSettings settings("YouCpp", "YouCpp");
     m_accessToken = settings.value("auth/accessToken").toString();
     m_refreshToken = settings.value("auth/refreshToken").toString();
-
-    if (m_accessToken.isEmpty() && !m_refreshToken.isEmpty()) {
-        refreshAccessToken();
-    }
+    m_expiresAt = settings.value("auth/expiresAt").toDateTime();
 }
 
 void GoogleAuth::saveTokens() {
     QSettings settings("YouCpp", "YouCpp");
     settings.setValue("auth/accessToken", m_accessToken);
     settings.setValue("auth/refreshToken", m_refreshToken);
+    settings.setValue("auth/expiresAt", m_expiresAt);
+}
+
+void GoogleAuth::applyTokenResponse(const QJsonObject &obj) {
+    m_accessToken = obj["access_token"].toString();
+
+    // Refresh responses usually omit refresh_token; keep the one we have
+    QString refreshToken = obj["refresh_token"].toString();
+    if (!refreshToken.isEmpty()) {
+        m_refreshToken = refreshToken;
+    }
+
+    int expiresIn = obj["expires_in"].toInt();
+    m_expiresAt = expiresIn > 0 ? QDateTime::currentDateTimeUtc().addSecs(expiresIn) : QDateTime();
+}
+
+void GoogleAuth::scheduleRefresh() {
+    m_refreshTimer->stop();
+    if (m_refreshToken.isEmpty() || !m_expiresAt.isValid()) return;
+
+    qint64 secs = QDateTime::currentDateTimeUtc().secsTo(m_expiresAt) - REFRESH_MARGIN_SECS;
+    m_refreshTimer->start(static_cast<int>(std::max<qint64>(secs, 0) * 1000));
 }
 
 void GoogleAuth::refreshAccessToken() {
+    if (m_refreshReply) return;
+
     if (m_refreshToken.isEmpty() || m_clientId.isEmpty() || m_clientSecret.isEmpty()) {
+        emit tokenRefreshFailed("Cannot refresh access token: not signed in or OAuth credentials not configured");
         return;
     }
+
+    LOG_INFO("GoogleAuth", "Refreshing access token...");
     
     QUrl tokenUrl(TOKEN_URL);
     QNetworkRequest request(tokenUrl);
@@ -198,21 +262,47 @@ void GoogleAuth::refreshAccessToken() {
     postData.addQueryItem("grant_type", "refresh_token");
     
     QNetworkReply *reply = m_networkManager->post(request, postData.toString(QUrl::FullyEncoded).toUtf8());
+    Metrics::trackReply(reply);
+    static Metrics::Counter &refreshes = Metrics::counter("auth.token_refreshes");
+    refreshes.add();
+    m_refreshReply = reply;
     
-    connect(reply, &QNetworkReply::finished, [this, reply]() {
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         reply->deleteLater();
+
+        // Aborted by logout()
+        if (m_refreshReply != reply) return;
+        m_refreshReply = nullptr;
         
         if (reply->error() != QNetworkReply::NoError) {
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            LOG_ERROR("GoogleAuth", "Token refresh ERROR (%d): %s", status, reply->errorString());
+            static Metrics::Counter &failures = Metrics::counter("auth.refresh_failures");
+            failures.add();
+
+            // 400/401 means the refresh token was revoked; anything else is worth retrying
+            if (status != 400 && status != 401) {
+                m_refreshTimer->start(REFRESH_RETRY_MSECS);
+            }
+            emit tokenRefreshFailed("Failed to refresh access token: " + reply->errorString());
             return;
         }
         
         QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
         QJsonObject obj = doc.object();
         
-        QString newAccessToken = obj["access_token"].toString();
-        if (!newAccessToken.isEmpty()) {
-            m_accessToken = newAccessToken;
-            saveTokens();
+        if (obj["access_token"].toString().isEmpty()) {
+            emit tokenRefreshFailed("No access token in refresh response");
+            return;
+        }
+
+        bool wasAuthenticated = isAuthenticated();
+        applyTokenResponse(obj);
+        saveTokens();
+        scheduleRefresh();
+
+        emit tokenRefreshed(m_accessToken);
+        if (!wasAuthenticated) {
             emit authenticated();
         }
     });
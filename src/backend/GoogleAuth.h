@@ -4,6 +4,12 @@
 #include <QNetworkAccessManager>
 #include <QTcpServer>
 #include <QSettings>
+#include <QDateTime>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkReply;
+class QJsonObject;
 
 class GoogleAuth : public QObject {
     Q_OBJECT
@@ -18,11 +24,21 @@ public:
     
     bool isAuthenticated() const;
     QString accessToken() const;
+    QDateTime expiresAt() const;
+    bool isTokenExpired() const;
+
+    // Single-flight: concurrent callers share the refresh already in flight
+    void refreshAccessToken();
+    bool isRefreshing() const;
 
 signals:
     void authenticated();
+    // startLogin() result: the consent page to open; the loopback server waits for its redirect
+    void authorizationUrlReady(const QUrl &url);
     void authenticationFailed(const QString &error);
     void loggedOut();
+    void tokenRefreshed(const QString &accessToken);
+    void tokenRefreshFailed(const QString &error);
 
 private slots:
     void handleNewConnection();
@@ -31,18 +47,24 @@ private slots:
 private:
     void loadTokens();
     void saveTokens();
-    void refreshAccessToken();
+    void applyTokenResponse(const QJsonObject &obj);
+    void scheduleRefresh();
     
     QString m_clientId;
     QString m_clientSecret;
     QString m_accessToken;
     QString m_refreshToken;
+    QDateTime m_expiresAt;
     
     QNetworkAccessManager *m_networkManager;
     QTcpServer *m_callbackServer;
     int m_callbackPort = 0;
+    QTimer *m_refreshTimer;
+    QNetworkReply *m_refreshReply = nullptr;
     
     static const QString AUTH_URL;
     static const QString TOKEN_URL;
     static const QString SCOPE;
+    static const int REFRESH_MARGIN_SECS;
+    static const int REFRESH_RETRY_MSECS;
 };
@@ -0,0 +1,367 @@
+#include "Log.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <ctime>
+
+std::atomic<int> Log::s_minLevel{Log::Info};
+
+const int Log::MAX_ARGS;
+const int Log::TEXT_BYTES;
+const int Log::RATE_LIMIT_PER_SECOND;
+
+namespace {
+
+// 4096 records of ~256 bytes; a burst beyond that is dropped, not waited out
+const size_t QUEUE_CAPACITY = 4096;
+const int IDLE_WAKE_MS = 50;
+
+qint64 wallClockMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+quint32 currentThreadNumber() {
+    static std::atomic<quint32> next{1};
+    thread_local quint32 number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+// Bounded MPMC queue (Vyukov): producers claim a cell with one CAS, the sequence number
+// publishes it. Used here with a single consumer, the writer thread.
+class RecordQueue {
+public:
+    RecordQueue() : m_cells(new Cell[QUEUE_CAPACITY]) {
+        for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const Log::Record &record) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &m_cells[pos & (QUEUE_CAPACITY - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = record;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(Log::Record *record) {
+        size_t pos = m_dequeuePos;
+        Cell *cell = &m_cells[pos & (QUEUE_CAPACITY - 1)];
+        if (cell->sequence.load(std::memory_order_acquire) != pos + 1) return false;
+        *record = cell->record;
+        cell->sequence.store(pos + QUEUE_CAPACITY, std::memory_order_release);
+        m_dequeuePos = pos + 1;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Log::Record record;
+    };
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) size_t m_dequeuePos = 0;
+};
+
+const char *levelName(Log::Level level) {
+    switch (level) {
+    case Log::Debug: return "debug";
+    case Log::Info: return "info";
+    case Log::Warning: return "warn";
+    case Log::Error: return "error";
+    }
+    return "info";
+}
+
+// Renders one conversion with the record's argument, whatever type the call site passed
+void formatArg(std::string &out, const Log::Record &record, const Log::Arg &arg, std::string spec, char conversion) {
+    if (arg.type == Log::Arg::String) {
+        out.append(record.text + arg.s.offset, arg.s.length);
+        return;
+    }
+    if (conversion == 'c') {
+        out += char(arg.type == Log::Arg::Int ? arg.i : qint64(arg.u));
+        return;
+    }
+
+    bool floating = std::strchr("eEfgGaA", conversion) != nullptr;
+    if (conversion == 's') {
+        floating = arg.type == Log::Arg::Double;
+        conversion = floating ? 'g' : (arg.type == Log::Arg::Int ? 'd' : 'u');
+    }
+
+    char buffer[128];
+    if (floating) {
+        double value = arg.type == Log::Arg::Double ? arg.d : (arg.type == Log::Arg::Int ? double(arg.i) : double(arg.u));
+        spec += conversion;
+        std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    } else if (conversion == 'd' || conversion == 'i') {
+        long long value = arg.type == Log::Arg::Double ? (long long)arg.d
+                        : (arg.type == Log::Arg::Int ? (long long)arg.i : (long long)arg.u);
+        spec += "lld";
+        std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    } else {
+        unsigned long long value = arg.type == Log::Arg::Double ? (unsigned long long)arg.d
+                                 : (arg.type == Log::Arg::Int ? (unsigned long long)arg.i : (unsigned long long)arg.u);
+        spec += "ll";
+        spec += std::strchr("uxXo", conversion) ? conversion : 'u';
+        std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    }
+    out += buffer;
+}
+
+std::string formatMessage(const Log::Record &record) {
+    std::string out;
+    int next = 0;
+    for (const char *p = record.format; *p; ++p) {
+        if (*p != '%') {
+            out += *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out += '%';
+            ++p;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion; the length modifier is re-derived
+        std::string spec = "%";
+        const char *q = p + 1;
+        while (*q && std::strchr("-+ #0", *q)) spec += *q++;
+        while (*q && (std::isdigit((unsigned char)*q) || *q == '.')) spec += *q++;
+        while (*q && std::strchr("hlLqjzt", *q)) ++q;
+        if (!*q) break;
+
+        if (next < record.argCount) {
+            formatArg(out, record, record.args[next++], spec, *q);
+        } else {
+            out += "<?>";
+        }
+        p = q;
+    }
+    return out;
+}
+
+void appendJsonString(std::string &out, const std::string &text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += char(c);
+            }
+        }
+    }
+    out += '"';
+}
+
+class Writer {
+public:
+    Writer() : m_thread([this]() { run(); }) {}
+
+    ~Writer() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    void push(const Log::Record &record) {
+        if (!m_queue.tryPush(record)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_pushed.fetch_add(1, std::memory_order_release);
+        // Warnings and errors go out promptly; the rest ride the next idle wake-up
+        if (record.level >= Log::Warning) m_wake.notify_one();
+    }
+
+    void flush() {
+        quint64 target = m_pushed.load(std::memory_order_acquire);
+        m_wake.notify_one();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_flushed.wait(lock, [this, target]() { return m_written >= target || m_stopping; });
+    }
+
+    void setOutput(FILE *out) { m_out.store(out, std::memory_order_relaxed); }
+    void setJson(bool json) { m_json.store(json, std::memory_order_relaxed); }
+
+private:
+    void run() {
+        Log::Record record;
+        std::string lines;
+        for (;;) {
+            quint64 written = 0;
+            while (m_queue.tryPop(&record)) {
+                appendLine(lines, record);
+                ++written;
+                if (lines.size() > 64 * 1024) writeOut(lines);
+            }
+            if (qint64 dropped = m_dropped.exchange(0, std::memory_order_relaxed)) {
+                lines += "[Log] " + std::to_string(dropped) + " message(s) dropped, queue full\n";
+            }
+            writeOut(lines);
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_written += written;
+            m_flushed.notify_all();
+            if (m_stopping && written == 0) return;
+            if (written == 0) {
+                m_wake.wait_for(lock, std::chrono::milliseconds(IDLE_WAKE_MS));
+            }
+        }
+    }
+
+    void writeOut(std::string &lines) {
+        if (lines.empty()) return;
+        FILE *out = m_out.load(std::memory_order_relaxed);
+        std::fwrite(lines.data(), 1, lines.size(), out);
+        std::fflush(out);
+        lines.clear();
+    }
+
+    void appendLine(std::string &out, const Log::Record &record) {
+        std::string message = formatMessage(record);
+        if (record.suppressed > 0) {
+            message += " (+" + std::to_string(record.suppressed) + " suppressed)";
+        }
+
+        time_t seconds = time_t(record.timeMs / 1000);
+        struct tm local;
+#ifdef Q_OS_WIN
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        char stamp[32];
+        std::snprintf(stamp, sizeof(stamp), "%02d:%02d:%02d.%03d",
+                      local.tm_hour, local.tm_min, local.tm_sec, int(record.timeMs % 1000));
+
+        if (m_json.load(std::memory_order_relaxed)) {
+            out += "{\"ts\":" + std::to_string(record.timeMs) + ",\"level\":\"" + levelName(record.level)
+                 + "\",\"tag\":";
+            appendJsonString(out, record.tag);
+            out += ",\"thread\":" + std::to_string(record.thread) + ",\"msg\":";
+            appendJsonString(out, message);
+            out += "}\n";
+        } else {
+            out += stamp;
+            out += record.level == Log::Error ? " E [" : record.level == Log::Warning ? " W [" : record.level == Log::Debug ? " D [" : " I [";
+            out += record.tag;
+            out += "] ";
+            out += message;
+            out += '\n';
+        }
+    }
+
+    RecordQueue m_queue;
+    std::atomic<FILE *> m_out{stdout};
+    std::atomic<bool> m_json{false};
+    std::atomic<qint64> m_dropped{0};
+    std::atomic<quint64> m_pushed{0};
+    quint64 m_written = 0;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    std::thread m_thread;
+};
+
+// Started on first use; the destructor at exit drains the queue and joins the thread
+Writer &writer() {
+    static Writer instance;
+    return instance;
+}
+
+}
+
+void Log::configure() {
+    QByteArray level = qgetenv("YOUCPP_LOG_LEVEL").toLower();
+    if (level == "debug") setLevel(Debug);
+    else if (level == "info") setLevel(Info);
+    else if (level == "warn" || level == "warning") setLevel(Warning);
+    else if (level == "error") setLevel(Error);
+
+    writer().setJson(qgetenv("YOUCPP_LOG_FORMAT").toLower() == "json");
+}
+
+void Log::setOutput(FILE *out) {
+    writer().setOutput(out);
+}
+
+void Log::flush() {
+    writer().flush();
+}
+
+bool Log::begin(Site &site, Level level, const char *tag, const char *format, Record *record) {
+    qint64 now = wallClockMs();
+
+    qint64 window = now / 1000;
+    qint64 current = site.window.load(std::memory_order_relaxed);
+    if (current != window && site.window.compare_exchange_strong(current, window, std::memory_order_relaxed)) {
+        site.count.store(0, std::memory_order_relaxed);
+    }
+    if (site.count.fetch_add(1, std::memory_order_relaxed) >= RATE_LIMIT_PER_SECOND) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    record->timeMs = now;
+    record->tag = tag;
+    record->format = format;
+    record->thread = currentThreadNumber();
+    record->suppressed = quint32(site.suppressed.exchange(0, std::memory_order_relaxed));
+    record->level = level;
+    record->argCount = 0;
+    record->textUsed = 0;
+    return true;
+}
+
+void Log::enqueue(const Record &record) {
+    writer().push(record);
+}
+
+void Log::packString(Record &record, const char *data, qsizetype size) {
+    Arg &arg = record.args[record.argCount++];
+    arg.type = Arg::String;
+    qsizetype room = TEXT_BYTES - record.textUsed;
+    qsizetype length = std::min(size, room);
+    // Don't cut a UTF-8 sequence in half
+    if (length < size) {
+        while (length > 0 && (static_cast<unsigned char>(data[length]) & 0xC0) == 0x80) --length;
+    }
+    if (length > 0) std::memcpy(record.text + record.textUsed, data, length);
+    arg.s.offset = record.textUsed;
+    arg.s.length = quint16(length);
+    record.textUsed += quint16(length);
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <cstdio>
+#include <type_traits>
+
+// Asynchronous logger. A call copies its arguments into a fixed-size record and pushes it onto a
+// bounded lock-free queue; a background thread does the printf-style formatting and the I/O. Nothing
+// on the calling thread blocks: a full queue drops the record and counts it. Each call site is
+// rate-limited, and the number suppressed is appended to its next line.
+//
+//   LOG_INFO("YouTubeService", "Found %d subscriptions", count);
+//
+// Tags and format strings must be string literals. QString/QByteArray/const char* arguments are
+// copied (truncated past ~120 bytes per record). YOUCPP_LOG_LEVEL=debug|info|warn|error sets the
+// threshold and YOUCPP_LOG_FORMAT=json switches to one JSON object per line.
+class Log {
+public:
+    enum Level : quint8 { Debug, Info, Warning, Error };
+
+    // Applies YOUCPP_LOG_LEVEL / YOUCPP_LOG_FORMAT; call after the environment is loaded
+    static void configure();
+    static void setLevel(Level level) { s_minLevel.store(level, std::memory_order_relaxed); }
+    // Defaults to stdout
+    static void setOutput(FILE *out);
+    // Blocks until everything queued so far is written
+    static void flush();
+
+    static bool isEnabled(Level level) { return level >= s_minLevel.load(std::memory_order_relaxed); }
+
+    static const int MAX_ARGS = 6;
+    static const int TEXT_BYTES = 120;
+    static const int RATE_LIMIT_PER_SECOND = 20;
+
+    // Per-call-site rate limit state, one static instance per LOG_* expansion
+    struct Site {
+        std::atomic<qint64> window{0};
+        std::atomic<int> count{0};
+        std::atomic<int> suppressed{0};
+    };
+
+    struct Arg {
+        enum Type : quint8 { Int, UInt, Double, String } type;
+        union {
+            qint64 i;
+            quint64 u;
+            double d;
+            struct {
+                quint16 offset;
+                quint16 length;
+            } s;
+        };
+    };
+
+    struct Record {
+        qint64 timeMs;
+        const char *tag;
+        const char *format;
+        quint32 thread;
+        quint32 suppressed;
+        Level level;
+        quint8 argCount;
+        quint16 textUsed;
+        Arg args[MAX_ARGS];
+        char text[TEXT_BYTES];
+    };
+
+    template <typename... Args>
+    static void write(Site &site, Level level, const char *tag, const char *format, const Args &...args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        Record record;
+        if (!begin(site, level, tag, format, &record)) return;
+        (pack(record, args), ...);
+        enqueue(record);
+    }
+
+private:
+    static bool begin(Site &site, Level level, const char *tag, const char *format, Record *record);
+    static void enqueue(const Record &record);
+    static void packString(Record &record, const char *data, qsizetype size);
+
+    template <typename T>
+    static void pack(Record &record, const T &value) {
+        Arg &arg = record.args[record.argCount++];
+        if constexpr (std::is_floating_point_v<T>) {
+            arg.type = Arg::Double;
+            arg.d = value;
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.type = Arg::Int;
+            arg.i = value;
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            arg.type = Arg::UInt;
+            arg.u = static_cast<quint64>(value);
+        } else {
+            --record.argCount;
+            packString(record, value);
+        }
+    }
+    static void packString(Record &record, const char *value) {
+        packString(record, value, value ? qsizetype(qstrlen(value)) : 0);
+    }
+    static void packString(Record &record, const QByteArray &value) {
+        packString(record, value.constData(), value.size());
+    }
+    static void packString(Record &record, const QString &value) {
+        packString(record, value.toUtf8());
+    }
+
+    static std::atomic<int> s_minLevel;
+};
+
+#define YOUCPP_LOG(level, tag, ...)                                   \
+    do {                                                              \
+        if (Log::isEnabled(level)) {                                  \
+            static Log::Site youcppLogSite_;                          \
+            Log::write(youcppLogSite_, level, tag, __VA_ARGS__);      \
+        }                                                             \
+    } while (0)
+
+#define LOG_DEBUG(tag, ...) YOUCPP_LOG(Log::Debug, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...) YOUCPP_LOG(Log::Info, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...) YOUCPP_LOG(Log::Warning, tag, __VA_ARGS__)
+#define LOG_ERROR(tag, ...) YOUCPP_LOG(Log::Error, tag, __VA_ARGS__)
@@ -0,0 +1,110 @@
+#include "Metrics.h"
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::map<QString, std::unique_ptr<Metrics::Counter>> counters;
+    std::map<QString, std::unique_ptr<Metrics::Gauge>> gauges;
+    std::map<QString, std::unique_ptr<Metrics::Histogram>> histograms;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+template <typename T>
+T &lookup(std::map<QString, std::unique_ptr<T>> &metrics, const QString &name) {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    std::unique_ptr<T> &slot = metrics[name];
+    if (!slot) slot = std::make_unique<T>();
+    return *slot;
+}
+
+}
+
+void Metrics::Histogram::record(qint64 value) {
+    // Bucket i holds [2^(i-1), 2^i); bucket 0 holds zero and below
+    int bucket = value > 0 ? 64 - qCountLeadingZeroBits(quint64(value)) : 0;
+    m_buckets[std::min(bucket, BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    qint64 seen = m_max.load(std::memory_order_relaxed);
+    while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 Metrics::Histogram::quantile(double q) const {
+    qint64 total = count();
+    if (total == 0) return 0;
+
+    qint64 rank = std::max<qint64>(1, qint64(q * total + 0.5));
+    qint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            qint64 upper = i == 0 ? 0 : (i >= 63 ? max() : (qint64(1) << i) - 1);
+            return std::min(upper, max());
+        }
+    }
+    return max();
+}
+
+Metrics::Counter &Metrics::counter(const QString &name) {
+    return lookup(registry().counters, name);
+}
+
+Metrics::Gauge &Metrics::gauge(const QString &name) {
+    return lookup(registry().gauges, name);
+}
+
+Metrics::Histogram &Metrics::histogram(const QString &name) {
+    return lookup(registry().histograms, name);
+}
+
+QList<Metrics::Sample> Metrics::snapshot(const QString &prefix) {
+    Registry &reg = registry();
+    QList<Sample> samples;
+
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &[name, counter] : reg.counters) {
+        if (name.startsWith(prefix)) samples.append({name, Sample::CounterSample, counter->value()});
+    }
+    for (const auto &[name, gauge] : reg.gauges) {
+        if (name.startsWith(prefix)) samples.append({name, Sample::GaugeSample, gauge->value()});
+    }
+    for (const auto &[name, histogram] : reg.histograms) {
+        if (!name.startsWith(prefix)) continue;
+        samples.append({name, Sample::HistogramSample, histogram->count(),
+                        histogram->quantile(0.5), histogram->quantile(0.95), histogram->max()});
+    }
+
+    std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.name < b.name; });
+    return samples;
+}
+
+void Metrics::trackReply(QNetworkReply *reply) {
+    QString host = reply->url().host();
+    Gauge &inFlight = gauge("net.in_flight." + host);
+    inFlight.add(1);
+    counter("net.requests." + host).add();
+
+    QElapsedTimer timer;
+    timer.start();
+    QObject::connect(reply, &QNetworkReply::finished, reply, [reply, host, timer, &inFlight]() {
+        inFlight.add(-1);
+        histogram("net.latency_ms." + host).record(timer.elapsed());
+        if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError) {
+            counter("net.errors." + host).add();
+        }
+    });
+}
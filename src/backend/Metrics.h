@@ -0,0 +1,74 @@
+#pragma once
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+class QNetworkReply;
+
+// Process-wide counters, gauges and histograms, shown in the Diagnostics tab. Look a metric up
+// once and keep the reference (the registry is locked only for lookups and snapshots); updates
+// are relaxed atomics and safe from any thread. Metrics are never removed.
+//
+// Names are dotted, most general part first: "net.in_flight.www.googleapis.com".
+class Metrics {
+public:
+    class Counter {
+    public:
+        void add(qint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    class Gauge {
+    public:
+        void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+        void add(qint64 n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    // Power-of-two buckets, so quantiles are upper bounds within a factor of two
+    class Histogram {
+    public:
+        static const int BUCKETS = 48;
+
+        void record(qint64 value);
+        qint64 count() const { return m_count.load(std::memory_order_relaxed); }
+        qint64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+        qint64 max() const { return m_max.load(std::memory_order_relaxed); }
+        // q in [0, 1]
+        qint64 quantile(double q) const;
+
+    private:
+        std::atomic<qint64> m_buckets[BUCKETS] = {};
+        std::atomic<qint64> m_count{0};
+        std::atomic<qint64> m_sum{0};
+        std::atomic<qint64> m_max{0};
+    };
+
+    static Counter &counter(const QString &name);
+    static Gauge &gauge(const QString &name);
+    static Histogram &histogram(const QString &name);
+
+    struct Sample {
+        enum Kind { CounterSample, GaugeSample, HistogramSample };
+        QString name;
+        Kind kind = CounterSample;
+        // Counter/gauge value, or the histogram's count
+        qint64 value = 0;
+        qint64 p50 = 0;
+        qint64 p95 = 0;
+        qint64 max = 0;
+    };
+    // Every metric whose name starts with prefix, sorted by name
+    static QList<Sample> snapshot(const QString &prefix = QString());
+
+    // Counts the reply under net.requests/net.errors/net.in_flight.<host> and records its
+    // latency in net.latency_ms.<host>
+    static void trackReply(QNetworkReply *reply);
+};
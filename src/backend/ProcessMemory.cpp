@@ -0,0 +1,33 @@
+#include "ProcessMemory.h"
+#include <QFile>
+#include <QByteArray>
+
+qint64 ProcessMemory::residentBytes(qint64 pid) {
+    return readStatusField(pid, "VmRSS:");
+}
+
+qint64 ProcessMemory::peakResidentBytes(qint64 pid) {
+    return readStatusField(pid, "VmHWM:");
+}
+
+qint64 ProcessMemory::readStatusField(qint64 pid, const char *field) {
+#ifdef Q_OS_LINUX
+    QFile file(pid > 0 ? QString("/proc/%1/status").arg(pid) : QString("/proc/self/status"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // e.g. "VmRSS:	  123456 kB"
+    const QByteArray key(field);
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (line.startsWith(key)) {
+            return line.mid(key.size()).trimmed().split(' ').value(0).toLongLong() * 1024;
+        }
+    }
+    return 0;
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(field);
+    return 0;
+#endif
+}
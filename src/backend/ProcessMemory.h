@@ -0,0 +1,13 @@
+#pragma once
+#include <QtGlobal>
+
+// Resident memory of a process, read from the OS. Returns 0 where unsupported.
+class ProcessMemory {
+public:
+    // pid 0 means the current process
+    static qint64 residentBytes(qint64 pid = 0);
+    static qint64 peakResidentBytes(qint64 pid = 0);
+
+private:
+    static qint64 readStatusField(qint64 pid, const char *field);
+};
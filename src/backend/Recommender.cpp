@@ -0,0 +1,154 @@
+#include "Recommender.h"
+#include <algorithm>
+#include <cmath>
+
+const int Recommender::WATCH_HISTORY_LIMIT = 500;
+const int Recommender::CANDIDATES_PER_CHANNEL = 30;
+const int Recommender::PER_CHANNEL_RESULTS = 3;
+const int Recommender::MIN_CHANNEL_WATCHES = 2;
+const double Recommender::SUBSCRIPTION_AFFINITY = 1.0;
+const double Recommender::WATCH_HALF_LIFE_DAYS = 30.0;
+const double Recommender::FRESHNESS_HALF_LIFE_DAYS = 7.0;
+
+void Recommender::setSubscribedChannels(const QStringList &channelIds) {
+    QSet<QString> subscribed(channelIds.begin(), channelIds.end());
+    QSet<QString> changed = (m_subscribed - subscribed) + (subscribed - m_subscribed);
+    m_subscribed = subscribed;
+
+    for (const QString &channelId : changed) {
+        m_channels[channelId].subscribed = m_subscribed.contains(channelId);
+        updateEligibility(channelId);
+    }
+}
+
+void Recommender::addCandidates(const QList<VideoResult> &videos) {
+    for (const auto &vid : videos) {
+        if (vid.id.isEmpty() || vid.channelId.isEmpty()) continue;
+
+        Channel &channel = m_channels[vid.channelId];
+        auto existing = std::find_if(channel.candidates.begin(), channel.candidates.end(),
+                                     [&vid](const Candidate &c) { return c.video.id == vid.id; });
+        if (existing != channel.candidates.end()) {
+            // Playlist items carry no statistics; keep what an earlier page had
+            VideoResult merged = vid;
+            if (merged.viewCount == 0) merged.viewCount = existing->video.viewCount;
+            if (merged.likeCount == 0) merged.likeCount = existing->video.likeCount;
+            if (merged.duration.isEmpty()) merged.duration = existing->video.duration;
+            existing->video = merged;
+            continue;
+        }
+
+        Candidate candidate;
+        candidate.video = vid;
+        QDateTime published = QDateTime::fromString(vid.publishedAt, Qt::ISODate);
+        candidate.publishedAt = published.isValid() ? published.toSecsSinceEpoch() : 0;
+
+        auto pos = std::upper_bound(channel.candidates.begin(), channel.candidates.end(), candidate.publishedAt,
+                                    [](qint64 publishedAt, const Candidate &c) { return publishedAt > c.publishedAt; });
+        if (pos - channel.candidates.begin() >= CANDIDATES_PER_CHANNEL) continue;
+        channel.candidates.insert(pos, candidate);
+        m_videoChannels.insert(vid.id, vid.channelId);
+
+        if (channel.candidates.size() > CANDIDATES_PER_CHANNEL) {
+            m_videoChannels.remove(channel.candidates.last().video.id);
+            channel.candidates.removeLast();
+        }
+    }
+}
+
+void Recommender::updateStatistics(const VideoResult &video) {
+    auto channelId = m_videoChannels.constFind(video.id);
+    if (channelId == m_videoChannels.constEnd()) return;
+
+    for (Candidate &candidate : m_channels[*channelId].candidates) {
+        if (candidate.video.id != video.id) continue;
+        if (video.viewCount) candidate.video.viewCount = video.viewCount;
+        if (video.likeCount) candidate.video.likeCount = video.likeCount;
+        if (!video.duration.isEmpty()) candidate.video.duration = video.duration;
+        return;
+    }
+}
+
+void Recommender::recordWatch(Watch watch) {
+    if (watch.videoId.isEmpty()) return;
+    if (watch.channelId.isEmpty()) watch.channelId = m_videoChannels.value(watch.videoId);
+
+    m_history.append(watch);
+    ++m_watchedVideos[watch.videoId];
+    if (!watch.channelId.isEmpty()) {
+        m_channels[watch.channelId].watchTimes.append(watch.watchedAt);
+        updateEligibility(watch.channelId);
+    }
+
+    while (m_history.size() > WATCH_HISTORY_LIMIT) {
+        forgetOldestWatch();
+    }
+}
+
+QList<VideoResult> Recommender::recommend(int limit, const QDateTime &now, const QSet<QString> &excludedChannels) const {
+    const qint64 nowSecs = now.toSecsSinceEpoch();
+    struct Scored {
+        double score;
+        const Candidate *candidate;
+    };
+    QVector<Scored> scored;
+
+    for (const QString &channelId : m_eligible) {
+        auto found = m_channels.constFind(channelId);
+        if (found == m_channels.constEnd() || excludedChannels.contains(channelId)) continue;
+        const Channel &channel = *found;
+
+        double affinity = channel.subscribed ? SUBSCRIPTION_AFFINITY : 0.0;
+        for (qint64 watchedAt : channel.watchTimes) {
+            affinity += std::pow(0.5, std::max<qint64>(0, nowSecs - watchedAt) / 86400.0 / WATCH_HALF_LIFE_DAYS);
+        }
+
+        for (const Candidate &candidate : channel.candidates) {
+            if (m_watchedVideos.contains(candidate.video.id)) continue;
+
+            // Unknown upload dates count as a month old
+            double ageHours = candidate.publishedAt > 0
+                ? std::max<qint64>(0, nowSecs - candidate.publishedAt) / 3600.0
+                : 30 * 24.0;
+            double freshness = std::pow(0.5, ageHours / 24.0 / FRESHNESS_HALF_LIFE_DAYS);
+            // Views per hour since upload, damped so one viral video doesn't fill the tab
+            double velocity = std::log10(1.0 + candidate.video.viewCount / (ageHours + 2.0));
+            scored.append({affinity * freshness * (1.0 + velocity), &candidate});
+        }
+    }
+
+    std::sort(scored.begin(), scored.end(), [](const Scored &a, const Scored &b) { return a.score > b.score; });
+
+    QList<VideoResult> results;
+    QHash<QString, int> perChannel;
+    for (const Scored &s : scored) {
+        if (results.size() >= limit) break;
+        int &shown = perChannel[s.candidate->video.channelId];
+        if (shown >= PER_CHANNEL_RESULTS) continue;
+        ++shown;
+        results.append(s.candidate->video);
+    }
+    return results;
+}
+
+void Recommender::updateEligibility(const QString &channelId) {
+    const Channel &channel = m_channels[channelId];
+    if (channel.subscribed || channel.watchTimes.size() >= MIN_CHANNEL_WATCHES) {
+        m_eligible.insert(channelId);
+    } else {
+        m_eligible.remove(channelId);
+    }
+}
+
+void Recommender::forgetOldestWatch() {
+    Watch oldest = m_history.takeFirst();
+    auto count = m_watchedVideos.find(oldest.videoId);
+    if (count != m_watchedVideos.end() && --*count <= 0) m_watchedVideos.erase(count);
+
+    if (oldest.channelId.isEmpty()) return;
+    auto channel = m_channels.find(oldest.channelId);
+    if (channel == m_channels.end()) return;
+    // Watches are appended in order, so the channel's oldest is first
+    if (!channel->watchTimes.isEmpty()) channel->watchTimes.removeFirst();
+    updateEligibility(oldest.channelId);
+}
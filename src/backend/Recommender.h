@@ -0,0 +1,77 @@
+#pragma once
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "VideoResult.h"
+
+// On-device ranking for the For You tab: no API calls. Candidates are the videos the service has
+// already fetched (feed, search pages, the local index), bucketed by channel. Only channels the
+// user subscribes to or has watched at least MIN_CHANNEL_WATCHES times are eligible; their
+// unwatched videos score channel affinity x freshness x view velocity. Buckets and the eligible
+// set are updated as data arrives, so a ranking is one pass over the eligible buckets.
+// Not thread-safe.
+class Recommender {
+public:
+    struct Watch {
+        QString videoId;
+        QString channelId;
+        // Seconds since the epoch
+        qint64 watchedAt = 0;
+    };
+
+    void setSubscribedChannels(const QStringList &channelIds);
+    QStringList subscribedChannels() const { return m_subscribed.values(); }
+
+    // Adds or refreshes videos; ones without a channel id can't be attributed and are skipped
+    void addCandidates(const QList<VideoResult> &videos);
+    // Counts and duration only, e.g. from statistics that arrived after the candidate
+    void updateStatistics(const VideoResult &video);
+
+    // An empty channel id is filled in from the candidates when the video is one of them
+    void recordWatch(Watch watch);
+    // Oldest first, at most WATCH_HISTORY_LIMIT entries
+    const QVector<Watch> &watchHistory() const { return m_history; }
+
+    // Highest score first, at most PER_CHANNEL_RESULTS per channel
+    QList<VideoResult> recommend(int limit, const QDateTime &now, const QSet<QString> &excludedChannels) const;
+
+    int candidateCount() const { return m_videoChannels.size(); }
+
+    static const int WATCH_HISTORY_LIMIT;
+    static const int CANDIDATES_PER_CHANNEL;
+    static const int PER_CHANNEL_RESULTS;
+    static const int MIN_CHANNEL_WATCHES;
+    // Each watch adds up to 1 to the channel's affinity, a subscription adds this
+    static const double SUBSCRIPTION_AFFINITY;
+    static const double WATCH_HALF_LIFE_DAYS;
+    static const double FRESHNESS_HALF_LIFE_DAYS;
+
+private:
+    struct Candidate {
+        VideoResult video;
+        // Parsed once; 0 when unknown
+        qint64 publishedAt = 0;
+    };
+    struct Channel {
+        // Newest upload first, at most CANDIDATES_PER_CHANNEL
+        QVector<Candidate> candidates;
+        QVector<qint64> watchTimes;
+        bool subscribed = false;
+    };
+
+    void updateEligibility(const QString &channelId);
+    void forgetOldestWatch();
+
+    QHash<QString, Channel> m_channels;
+    QSet<QString> m_eligible;
+    QSet<QString> m_subscribed;
+    // Candidate video id -> channel id
+    QHash<QString, QString> m_videoChannels;
+    QVector<Watch> m_history;
+    // Watches per video still in the history
+    QHash<QString, int> m_watchedVideos;
+};
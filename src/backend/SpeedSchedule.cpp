@@ -0,0 +1,147 @@
+#include "SpeedSchedule.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+const double SpeedSchedule::NORMAL_WPS = 2.8;
+const double SpeedSchedule::MAX_SPEECH_BOOST = 1.5;
+const double SpeedSchedule::SILENCE_BOOST = 2.5;
+const int SpeedSchedule::MIN_SILENCE_MS = 1200;
+// Drop back to speech speed slightly before the next cue so its first word isn't clipped
+const int SpeedSchedule::SPEECH_LEAD_MS = 300;
+
+namespace {
+const int SCHEDULE_VERSION = 1;
+}
+
+SpeedSchedule SpeedSchedule::fromTranscript(const Transcript &transcript) {
+    SpeedSchedule schedule;
+    int count = transcript.size();
+    if (count == 0) return schedule;
+
+    // Speech multiplier per cue: inverse of its word rate, smoothed over neighbours so
+    // the rate doesn't flap cue to cue
+    QVector<double> speech(count, 1.0);
+    QVector<qint64> ends(count);
+    for (int i = 0; i < count; ++i) {
+        qint64 start = transcript.startMs(i);
+        qint64 end = transcript.endMs(i);
+        // Auto-generated cues overlap the next one; speech ends where the next cue starts
+        if (i + 1 < count) end = std::min(end, transcript.startMs(i + 1));
+        ends[i] = end;
+
+        qint64 duration = end - start;
+        int words = Transcript::tokenize(transcript.text(i)).size();
+        if (duration <= 0 || words == 0) continue;
+        double wps = words * 1000.0 / duration;
+        speech[i] = std::clamp(NORMAL_WPS / wps, 1.0, MAX_SPEECH_BOOST);
+    }
+    QVector<double> smoothed(count);
+    for (int i = 0; i < count; ++i) {
+        double sum = speech[i];
+        int n = 1;
+        if (i > 0) { sum += speech[i - 1]; ++n; }
+        if (i + 1 < count) { sum += speech[i + 1]; ++n; }
+        // Tenth steps: finer changes aren't audible and only cost rate switches
+        smoothed[i] = std::round(sum / n * 10.0) / 10.0;
+    }
+
+    qint64 firstStart = transcript.startMs(0);
+    if (firstStart >= MIN_SILENCE_MS) {
+        schedule.append(0, SILENCE_BOOST);
+    }
+    for (int i = 0; i < count; ++i) {
+        qint64 start = transcript.startMs(i);
+        qint64 speechFrom = start - SPEECH_LEAD_MS;
+        if (i == 0) speechFrom = firstStart >= MIN_SILENCE_MS ? speechFrom : 0;
+        schedule.append(std::max<qint64>(speechFrom, 0), smoothed[i]);
+
+        qint64 gapEnd = i + 1 < count ? transcript.startMs(i + 1) : -1;
+        // Trailing stretch after the last cue (outros, end cards) counts as silence
+        if (gapEnd < 0 || gapEnd - ends[i] >= MIN_SILENCE_MS) {
+            schedule.append(ends[i], SILENCE_BOOST);
+        }
+    }
+    return schedule;
+}
+
+void SpeedSchedule::append(qint64 startMs, double multiplier) {
+    if (!m_spans.isEmpty()) {
+        Span &last = m_spans.last();
+        if (std::abs(last.multiplier - multiplier) < 0.01) return;
+        // Lead time pulled this span back over the previous one; it wins
+        if (startMs <= last.startMs) {
+            last.multiplier = static_cast<float>(multiplier);
+            return;
+        }
+    }
+    m_spans.append({static_cast<qint32>(startMs), static_cast<float>(multiplier)});
+}
+
+double SpeedSchedule::multiplierAt(qint64 ms) const {
+    auto it = std::upper_bound(m_spans.begin(), m_spans.end(), ms, [](qint64 value, const Span &s) {
+        return value < s.startMs;
+    });
+    return it == m_spans.begin() ? 1.0 : (it - 1)->multiplier;
+}
+
+QVariantList SpeedSchedule::toVariantList() const {
+    QVariantList list;
+    list.reserve(m_spans.size() * 2);
+    for (const Span &span : m_spans) {
+        list.append(span.startMs);
+        list.append(span.multiplier);
+    }
+    return list;
+}
+
+QString SpeedSchedule::cachePath(const QString &videoId) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return dir + "/speed-schedules/" + videoId + ".json";
+}
+
+SpeedSchedule SpeedSchedule::load(const QString &videoId) {
+    SpeedSchedule schedule;
+
+    QFile file(cachePath(videoId));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return schedule;
+    }
+
+    // Older tuning produces different timelines; recompute rather than reuse
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != SCHEDULE_VERSION) {
+        return schedule;
+    }
+    for (const auto &value : root["spans"].toArray()) {
+        QJsonArray pair = value.toArray();
+        schedule.append(pair[0].toInteger(), pair[1].toDouble());
+    }
+    return schedule;
+}
+
+void SpeedSchedule::save(const QString &videoId) const {
+    QJsonArray spans;
+    for (const Span &span : m_spans) {
+        spans.append(QJsonArray{span.startMs, span.multiplier});
+    }
+    QJsonObject root;
+    root["version"] = SCHEDULE_VERSION;
+    root["spans"] = spans;
+
+    QString path = cachePath(videoId);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+#include "Transcript.h"
+
+// Per-video speed timeline derived from caption timing: a step function of multipliers on top of
+// the user's chosen rate. Slow speech is sped up, silences and caption-less stretches more so.
+class SpeedSchedule {
+public:
+    struct Span {
+        qint32 startMs = 0;
+        float multiplier = 1.0f;
+    };
+
+    static SpeedSchedule fromTranscript(const Transcript &transcript);
+
+    // On-disk cache in CacheLocation/speed-schedules; load() returns an empty schedule on a miss
+    static SpeedSchedule load(const QString &videoId);
+    void save(const QString &videoId) const;
+
+    bool isEmpty() const { return m_spans.isEmpty(); }
+    int size() const { return m_spans.size(); }
+    const Span &span(int index) const { return m_spans[index]; }
+    double multiplierAt(qint64 ms) const;
+
+    // Flat [startMs, multiplier, ...] list for the player bridge
+    QVariantList toVariantList() const;
+
+    // Tuning; speech rates are in words per second
+    static const double NORMAL_WPS;
+    static const double MAX_SPEECH_BOOST;
+    static const double SILENCE_BOOST;
+    static const int MIN_SILENCE_MS;
+    static const int SPEECH_LEAD_MS;
+
+private:
+    void append(qint64 startMs, double multiplier);
+    static QString cachePath(const QString &videoId);
+
+    QVector<Span> m_spans;
+};
@@ -0,0 +1,109 @@
+#include "SuggestionTrie.h"
+#include <algorithm>
+
+const int SuggestionTrie::MAX_VISITED_NODES = 50000;
+
+SuggestionTrie::SuggestionTrie() {
+    clear();
+}
+
+void SuggestionTrie::clear() {
+    m_nodes.clear();
+    m_entries.clear();
+    m_nodes.append(Node());
+}
+
+QString SuggestionTrie::normalize(const QString &text) {
+    return text.simplified().toLower();
+}
+
+int SuggestionTrie::findChild(int node, QChar ch) const {
+    for (int c = m_nodes[node].firstChild; c >= 0; c = m_nodes[c].nextSibling) {
+        if (m_nodes[c].ch == ch) return c;
+    }
+    return -1;
+}
+
+int SuggestionTrie::findNode(const QString &key) const {
+    int node = 0;
+    for (QChar ch : key) {
+        node = findChild(node, ch);
+        if (node < 0) return -1;
+    }
+    return node;
+}
+
+void SuggestionTrie::insert(const QString &text, double weight) {
+    QString key = normalize(text);
+    if (key.isEmpty()) return;
+
+    int node = 0;
+    for (QChar ch : key) {
+        int next = findChild(node, ch);
+        if (next < 0) {
+            Node child;
+            child.ch = ch;
+            child.nextSibling = m_nodes[node].firstChild;
+            next = m_nodes.size();
+            m_nodes.append(child);
+            m_nodes[node].firstChild = next;
+        }
+        node = next;
+    }
+
+    int entry = m_nodes[node].entry;
+    if (entry < 0) {
+        m_nodes[node].entry = m_entries.size();
+        m_entries.append({text.simplified(), weight, node});
+    } else if (weight > m_entries[entry].weight) {
+        m_entries[entry] = {text.simplified(), weight, node};
+    }
+}
+
+void SuggestionTrie::remove(const QString &text) {
+    QString key = normalize(text);
+    if (key.isEmpty()) return;
+    int node = findNode(key);
+    if (node < 0 || m_nodes[node].entry < 0) return;
+
+    // Move the last entry into the hole so entries stay dense
+    int entry = m_nodes[node].entry;
+    m_nodes[node].entry = -1;
+    int last = m_entries.size() - 1;
+    if (entry != last) {
+        m_entries[entry] = m_entries[last];
+        m_nodes[m_entries[entry].node].entry = entry;
+    }
+    m_entries.removeLast();
+}
+
+QStringList SuggestionTrie::complete(const QString &prefix, int limit) const {
+    QString key = normalize(prefix);
+    if (key.isEmpty() || limit <= 0) return {};
+
+    int node = findNode(key);
+    if (node < 0) return {};
+
+    QVector<int> found;
+    QVector<int> stack{node};
+    int visited = 0;
+    while (!stack.isEmpty() && visited < MAX_VISITED_NODES) {
+        int current = stack.takeLast();
+        ++visited;
+        if (m_nodes[current].entry >= 0) found.append(m_nodes[current].entry);
+        for (int c = m_nodes[current].firstChild; c >= 0; c = m_nodes[c].nextSibling) {
+            stack.append(c);
+        }
+    }
+
+    int count = std::min<int>(limit, found.size());
+    std::partial_sort(found.begin(), found.begin() + count, found.end(), [this](int a, int b) {
+        return m_entries[a].weight > m_entries[b].weight;
+    });
+
+    QStringList result;
+    for (int i = 0; i < count; ++i) {
+        result.append(m_entries[found[i]].text);
+    }
+    return result;
+}
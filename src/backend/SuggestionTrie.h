@@ -0,0 +1,44 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Prefix trie for local search suggestions. Keys are case-insensitive; completions come back
+// in their original spelling, heaviest first.
+class SuggestionTrie {
+public:
+    SuggestionTrie();
+
+    // Re-inserting an entry keeps the higher of the two weights
+    void insert(const QString &text, double weight);
+    // Drops the entry; its nodes stay and match nothing
+    void remove(const QString &text);
+    QStringList complete(const QString &prefix, int limit = 8) const;
+
+    int size() const { return m_entries.size(); }
+    void clear();
+
+    // Bounds the subtree walk for one- or two-letter prefixes over a large history
+    static const int MAX_VISITED_NODES;
+
+private:
+    // First-child/next-sibling layout keeps a node at 16 bytes
+    struct Node {
+        QChar ch;
+        qint32 firstChild = -1;
+        qint32 nextSibling = -1;
+        qint32 entry = -1;
+    };
+    struct Entry {
+        QString text;
+        double weight = 0;
+        qint32 node = -1;
+    };
+
+    static QString normalize(const QString &text);
+    int findChild(int node, QChar ch) const;
+    int findNode(const QString &key) const;
+
+    QVector<Node> m_nodes;
+    QVector<Entry> m_entries;
+};
@@ -0,0 +1,235 @@
+#include "Trace.h"
+#include "Log.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QNetworkReply>
+#include <QThread>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+// ~3.5 MB per thread that records anything; only allocated while tracing
+const int EVENTS_PER_THREAD = 1 << 16;
+
+struct Event {
+    const char *category;
+    const char *name;
+    const char *argName;
+    qint64 tsNs;
+    qint64 durNs;
+    qint64 arg;
+    quint64 id;
+    char phase;
+};
+
+// Written only by its own thread; count is published with release so the exporter can read
+// a consistent prefix while the thread keeps recording
+struct ThreadBuffer {
+    int tid = 0;
+    QByteArray threadName;
+    std::unique_ptr<Event[]> events{new Event[EVENTS_PER_THREAD]};
+    std::atomic<int> count{0};
+    std::atomic<qint64> dropped{0};
+};
+
+// Buffers outlive their threads (QThreadPool retires idle workers) until the trace is written
+std::mutex g_buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::atomic<quint64> g_nextAsyncId{1};
+std::chrono::steady_clock::time_point g_epoch;
+QString g_outputPath;
+thread_local ThreadBuffer *t_buffer = nullptr;
+
+// Stall attribution state, only touched on threads that called setSpanAttribution
+thread_local int t_openScopes = 0;
+thread_local const char *t_longestSpan = nullptr;
+thread_local qint64 t_longestSpanNs = 0;
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+ThreadBuffer *threadBuffer() {
+    if (t_buffer) return t_buffer;
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    QThread *thread = QThread::currentThread();
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && thread == app->thread()) {
+        buffer->threadName = "main";
+    } else if (thread && !thread->objectName().isEmpty()) {
+        buffer->threadName = thread->objectName().toUtf8();
+    }
+
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    buffer->tid = static_cast<int>(g_buffers.size()) + 1;
+    if (buffer->threadName.isEmpty()) buffer->threadName = "worker " + QByteArray::number(buffer->tid);
+    t_buffer = buffer.get();
+    g_buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+void record(const Event &event) {
+    ThreadBuffer *buffer = threadBuffer();
+    int index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= EVENTS_PER_THREAD) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = event;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void appendString(QByteArray &out, const char *text) {
+    out += '"';
+    for (const char *p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') out += '\\';
+        out += *p;
+    }
+    out += '"';
+}
+
+void appendMicros(QByteArray &out, qint64 ns) {
+    out += QByteArray::number(ns / 1000.0, 'f', 3);
+}
+
+}
+
+void Trace::init() {
+    QString path = qEnvironmentVariable("YOUCPP_TRACE");
+    if (path.isEmpty()) return;
+
+    g_outputPath = path;
+    g_epoch = std::chrono::steady_clock::now();
+    s_enabled.store(true, std::memory_order_relaxed);
+    LOG_INFO("Trace", "Recording to %s", path);
+}
+
+void Trace::shutdown() {
+    if (!s_enabled.exchange(false)) return;
+
+    if (writeJson(g_outputPath)) {
+        LOG_INFO("Trace", "Wrote %s", g_outputPath);
+    } else {
+        LOG_WARN("Trace", "Could not write %s", g_outputPath);
+    }
+}
+
+void Trace::Scope::begin(const char *category, const char *name) {
+    m_category = category;
+    m_name = name;
+    m_startNs = nowNs();
+}
+
+void Trace::Scope::end() {
+    qint64 endNs = nowNs();
+    record({m_category, m_name, m_argName, m_startNs, endNs - m_startNs, m_arg, 0, 'X'});
+}
+
+void Trace::Scope::attributeBegin(const char *name) {
+    m_attributing = true;
+    if (t_openScopes++ == 0) {
+        m_outerName = name;
+        m_outerStartNs = nowNs();
+    }
+}
+
+void Trace::Scope::attributeEnd() {
+    if (--t_openScopes > 0 || !m_outerName) return;
+    qint64 duration = nowNs() - m_outerStartNs;
+    if (duration > t_longestSpanNs) {
+        t_longestSpanNs = duration;
+        t_longestSpan = m_outerName;
+    }
+}
+
+const char *Trace::takeLongestSpan(qint64 *durationNs) {
+    const char *name = t_longestSpan;
+    if (durationNs) *durationNs = t_longestSpanNs;
+    t_longestSpan = nullptr;
+    t_longestSpanNs = 0;
+    return name;
+}
+
+quint64 Trace::recordAsyncBegin(const char *category, const char *name) {
+    quint64 id = g_nextAsyncId.fetch_add(1, std::memory_order_relaxed);
+    record({category, name, nullptr, nowNs(), 0, 0, id, 'b'});
+    return id;
+}
+
+void Trace::recordAsyncEnd(const char *category, const char *name, quint64 id, const char *argName, qint64 arg) {
+    record({category, name, argName, nowNs(), 0, arg, id, 'e'});
+}
+
+void Trace::recordInstant(const char *category, const char *name) {
+    record({category, name, nullptr, nowNs(), 0, 0, 0, 'i'});
+}
+
+void Trace::traceReply(QNetworkReply *reply, const char *name) {
+    quint64 id = beginAsync("net", name);
+    if (!id) return;
+    QObject::connect(reply, &QNetworkReply::finished, reply, [reply, name, id]() {
+        endAsync("net", name, id, "bytes", reply->bytesAvailable());
+    });
+}
+
+bool Trace::writeJson(const QString &path) {
+    QByteArray out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    for (const auto &buffer : g_buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+
+        separator();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendString(out, buffer->threadName.constData());
+        out += "}}";
+
+        int count = buffer->count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            const Event &e = buffer->events[i];
+            separator();
+            out += "{\"ph\":\"";
+            out += e.phase;
+            out += "\",\"cat\":";
+            appendString(out, e.category);
+            out += ",\"name\":";
+            appendString(out, e.name);
+            out += ",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+            appendMicros(out, e.tsNs);
+            if (e.phase == 'X') {
+                out += ",\"dur\":";
+                appendMicros(out, e.durNs);
+            } else if (e.phase == 'i') {
+                out += ",\"s\":\"t\"";
+            } else {
+                out += ",\"id\":\"0x" + QByteArray::number(e.id, 16) + '"';
+            }
+            if (e.argName) {
+                out += ",\"args\":{";
+                appendString(out, e.argName);
+                out += ':' + QByteArray::number(e.arg) + '}';
+            }
+            out += '}';
+        }
+
+        if (qint64 dropped = buffer->dropped.load(std::memory_order_relaxed)) {
+            LOG_WARN("Trace", "%s: buffer full, %lld events dropped", buffer->threadName, dropped);
+        }
+    }
+    out += "\n]}\n";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(out) == out.size();
+}
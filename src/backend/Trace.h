@@ -0,0 +1,91 @@
+#pragma once
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+class QNetworkReply;
+
+// Span tracing exported as Chrome trace_event JSON (chrome://tracing, ui.perfetto.dev).
+// YOUCPP_TRACE=<file.json> turns it on; the file is written by Trace::shutdown(). When off,
+// every entry point is an inlined relaxed load and a branch (scopes also test a thread-local flag).
+//
+// Events go into a fixed per-thread buffer without locking; names, categories and argument
+// names must be string literals (only the pointers are stored). A full buffer drops events.
+class Trace {
+public:
+    // Reads YOUCPP_TRACE; call once, early on the main thread
+    static void init();
+    // Writes the trace file if tracing is on; further events are ignored
+    static void shutdown();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Duration event covering the enclosing scope, with an optional integer argument
+    class Scope {
+    public:
+        Scope(const char *category, const char *name) {
+            if (s_attributing) attributeBegin(name);
+            if (isEnabled()) begin(category, name);
+        }
+        ~Scope() {
+            if (m_name) end();
+            if (m_attributing) attributeEnd();
+        }
+        void setArg(const char *name, qint64 value) {
+            m_argName = name;
+            m_arg = value;
+        }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        void begin(const char *category, const char *name);
+        void end();
+        void attributeBegin(const char *name);
+        void attributeEnd();
+
+        const char *m_category = nullptr;
+        const char *m_name = nullptr;
+        const char *m_argName = nullptr;
+        qint64 m_arg = 0;
+        qint64 m_startNs = 0;
+        bool m_attributing = false;
+        const char *m_outerName = nullptr;
+        qint64 m_outerStartNs = 0;
+    };
+
+    // Spans that start and finish in different callbacks; beginAsync returns 0 when off
+    static quint64 beginAsync(const char *category, const char *name) {
+        return isEnabled() ? recordAsyncBegin(category, name) : 0;
+    }
+    static void endAsync(const char *category, const char *name, quint64 id,
+                         const char *argName = nullptr, qint64 arg = 0) {
+        if (id) recordAsyncEnd(category, name, id, argName, arg);
+    }
+
+    static void instant(const char *category, const char *name) {
+        if (isEnabled()) recordInstant(category, name);
+    }
+
+    // Async "net" span from now until the reply finishes, with the response size; connect this
+    // before the reply's own finished handler so the body hasn't been read yet
+    static void traceReply(QNetworkReply *reply, const char *name);
+
+    // Stall attribution, independent of tracing: once a thread opts in, its outermost scopes are
+    // timed and the longest one since the last take is kept (EventLoopMonitor on the GUI thread)
+    static void setSpanAttribution(bool on) { s_attributing = on; }
+    static const char *takeLongestSpan(qint64 *durationNs);
+
+private:
+    static quint64 recordAsyncBegin(const char *category, const char *name);
+    static void recordAsyncEnd(const char *category, const char *name, quint64 id,
+                               const char *argName, qint64 arg);
+    static void recordInstant(const char *category, const char *name);
+    static bool writeJson(const QString &path);
+
+    static std::atomic<bool> s_enabled;
+    static inline thread_local bool s_attributing = false;
+};
+
+#define YOUCPP_TRACE_CONCAT_(a, b) a##b
+#define YOUCPP_TRACE_CONCAT(a, b) YOUCPP_TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(category, name) Trace::Scope YOUCPP_TRACE_CONCAT(traceScope_, __LINE__)(category, name)
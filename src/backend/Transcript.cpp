@@ -0,0 +1,278 @@
+#include "Transcript.h"
+#include "Trace.h"
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <algorithm>
+
+namespace {
+
+// Timed-text escapes its payload twice (&amp;#39;), so one XML-reader pass leaves entities behind;
+// WebVTT escapes once. Each format's text goes through here exactly once.
+QString decodeEntities(const QString &text) {
+    if (!text.contains('&')) return text;
+
+    QString out;
+    out.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        if (text[i] != '&') {
+            out += text[i];
+            continue;
+        }
+        int semi = text.indexOf(';', i + 1);
+        if (semi < 0 || semi - i > 10) {
+            out += text[i];
+            continue;
+        }
+        QStringView name = QStringView(text).mid(i + 1, semi - i - 1);
+        if (name == u"amp") out += '&';
+        else if (name == u"lt") out += '<';
+        else if (name == u"gt") out += '>';
+        else if (name == u"quot") out += '"';
+        else if (name == u"apos") out += '\'';
+        else if (name == u"nbsp") out += ' ';
+        else if (name.startsWith('#')) {
+            bool ok = false;
+            uint code = name.startsWith(u"#x") || name.startsWith(u"#X")
+                ? name.mid(2).toUInt(&ok, 16)
+                : name.mid(1).toUInt(&ok, 10);
+            if (!ok) {
+                out += text[i];
+                continue;
+            }
+            char32_t ch = code;
+            out += QString::fromUcs4(&ch, 1);
+        } else {
+            out += text[i];
+            continue;
+        }
+        i = semi;
+    }
+    return out;
+}
+
+// "01:02:03.456" or "02:03.456"; -1 if malformed
+qint64 parseVttTime(const QString &stamp) {
+    static const QRegularExpression re("^(?:(\\d+):)?(\\d{1,2}):(\\d{2})[.,](\\d{3})$");
+    QRegularExpressionMatch m = re.match(stamp);
+    if (!m.hasMatch()) return -1;
+
+    qint64 hours = m.captured(1).isEmpty() ? 0 : m.captured(1).toLongLong();
+    return ((hours * 60 + m.captured(2).toLongLong()) * 60 + m.captured(3).toLongLong()) * 1000
+           + m.captured(4).toLongLong();
+}
+
+}
+
+Transcript Transcript::parse(const QByteArray &data) {
+    Trace::Scope span("parse", "Transcript::parse");
+    span.setArg("bytes", data.size());
+    QByteArray head = data.left(64).trimmed();
+    if (head.startsWith("\xEF\xBB\xBF")) {
+        head = head.mid(3);
+    }
+    return head.startsWith("WEBVTT") ? parseVtt(data) : parseXml(data);
+}
+
+Transcript Transcript::loadFromFile(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return Transcript();
+    return parse(file.readAll());
+}
+
+Transcript Transcript::parseXml(const QByteArray &data) {
+    Transcript transcript;
+    QXmlStreamReader xml(data);
+
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) continue;
+
+        QXmlStreamAttributes attrs = xml.attributes();
+        if (xml.name() == u"text") {
+            // srv1: seconds as decimals
+            qint64 start = qRound64(attrs.value("start").toDouble() * 1000);
+            qint64 dur = qRound64(attrs.value("dur").toDouble() * 1000);
+            transcript.append(start, dur, decodeEntities(xml.readElementText(QXmlStreamReader::IncludeChildElements)));
+        } else if (xml.name() == u"p") {
+            // srv3: integer milliseconds, words may be split into <s> children
+            qint64 start = attrs.value("t").toLongLong();
+            qint64 dur = attrs.value("d").toLongLong();
+            transcript.append(start, dur, decodeEntities(xml.readElementText(QXmlStreamReader::IncludeChildElements)));
+        }
+    }
+
+    transcript.finalize();
+    return transcript;
+}
+
+Transcript Transcript::parseVtt(const QByteArray &data) {
+    static const QRegularExpression tagRe("<[^>]*>");
+
+    Transcript transcript;
+    QStringList lines = QString::fromUtf8(data).split('\n');
+    QSet<QString> previousCueLines;
+
+    for (int i = 0; i < lines.size(); ++i) {
+        QString line = lines[i].trimmed();
+        int arrow = line.indexOf("-->");
+        if (arrow < 0) continue;
+
+        qint64 start = parseVttTime(line.left(arrow).trimmed());
+        qint64 end = parseVttTime(line.mid(arrow + 3).trimmed().section(' ', 0, 0));
+        if (start < 0 || end < start) continue;
+
+        QStringList cueLines;
+        while (i + 1 < lines.size() && !lines[i + 1].trimmed().isEmpty()) {
+            QString text = decodeEntities(lines[++i].remove(tagRe).trimmed());
+            if (!text.isEmpty()) cueLines.append(text);
+        }
+
+        // Auto-generated tracks roll: each cue repeats the line before it, so keep only new lines
+        QStringList fresh;
+        for (const QString &text : cueLines) {
+            if (!previousCueLines.contains(text)) fresh.append(text);
+        }
+        if (!cueLines.isEmpty()) {
+            previousCueLines = QSet<QString>(cueLines.begin(), cueLines.end());
+        }
+        transcript.append(start, end - start, fresh.join(' '));
+    }
+
+    transcript.finalize();
+    return transcript;
+}
+
+void Transcript::append(qint64 startMs, qint64 durationMs, const QString &text) {
+    QString clean = text.simplified();
+    if (clean.isEmpty()) return;
+
+    Segment segment;
+    segment.startMs = static_cast<qint32>(startMs);
+    segment.durationMs = static_cast<qint32>(std::max<qint64>(durationMs, 0));
+    segment.textOffset = m_text.size();
+    segment.textLength = clean.size();
+    m_segments.append(segment);
+
+    m_text += clean;
+    m_text += '\n';
+}
+
+void Transcript::finalize() {
+    std::stable_sort(m_segments.begin(), m_segments.end(), [](const Segment &a, const Segment &b) {
+        return a.startMs < b.startMs;
+    });
+    m_segments.squeeze();
+    m_text.squeeze();
+
+    QHash<QString, QVector<qint32>> postings;
+    for (int i = 0; i < m_segments.size(); ++i) {
+        for (const QString &term : tokenize(text(i))) {
+            QVector<qint32> &list = postings[term];
+            if (list.isEmpty() || list.last() != i) list.append(i);
+        }
+    }
+
+    m_terms = postings.keys();
+    std::sort(m_terms.begin(), m_terms.end());
+
+    m_postingStarts.clear();
+    m_postingStarts.reserve(m_terms.size() + 1);
+    m_postings.clear();
+    for (const QString &term : m_terms) {
+        m_postingStarts.append(m_postings.size());
+        m_postings += postings.value(term);
+    }
+    m_postingStarts.append(m_postings.size());
+    m_postings.squeeze();
+}
+
+QString Transcript::text(int index) const {
+    const Segment &segment = m_segments[index];
+    return m_text.mid(segment.textOffset, segment.textLength);
+}
+
+int Transcript::segmentAt(qint64 ms) const {
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), ms, [](qint64 value, const Segment &s) {
+        return value < s.startMs;
+    });
+    return static_cast<int>(it - m_segments.begin()) - 1;
+}
+
+QVector<int> Transcript::postingsFor(const QString &term, bool prefix) const {
+    auto first = std::lower_bound(m_terms.begin(), m_terms.end(), term);
+    int index = static_cast<int>(first - m_terms.begin());
+
+    QVector<int> result;
+    if (!prefix) {
+        if (index < m_terms.size() && m_terms[index] == term) {
+            for (int p = m_postingStarts[index]; p < m_postingStarts[index + 1]; ++p) {
+                result.append(m_postings[p]);
+            }
+        }
+        return result;
+    }
+
+    int termCount = 0;
+    for (int t = index; t < m_terms.size() && m_terms[t].startsWith(term); ++t, ++termCount) {
+        for (int p = m_postingStarts[t]; p < m_postingStarts[t + 1]; ++p) {
+            result.append(m_postings[p]);
+        }
+    }
+    if (termCount > 1) {
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+    return result;
+}
+
+QVector<int> Transcript::search(const QString &query, int limit) const {
+    QStringList tokens = tokenize(query);
+    if (tokens.isEmpty()) return {};
+
+    QVector<int> hits;
+    for (int i = 0; i < tokens.size(); ++i) {
+        QVector<int> matches = postingsFor(tokens[i], i == tokens.size() - 1);
+        if (i == 0) {
+            hits = matches;
+        } else {
+            QVector<int> both;
+            std::set_intersection(hits.begin(), hits.end(), matches.begin(), matches.end(), std::back_inserter(both));
+            hits.swap(both);
+        }
+        if (hits.isEmpty()) break;
+    }
+
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+QStringList Transcript::tokenize(const QString &text) {
+    QStringList tokens;
+    QString current;
+    for (QChar ch : text) {
+        if (ch.isLetterOrNumber()) {
+            current += ch.toLower();
+        } else if ((ch == '\'' || ch == QChar(0x2019)) && !current.isEmpty()) {
+            // "don't" indexes as "dont"
+            continue;
+        } else if (!current.isEmpty()) {
+            tokens.append(current);
+            current.clear();
+        }
+    }
+    if (!current.isEmpty()) tokens.append(current);
+    return tokens;
+}
+
+QString Transcript::formatTimestamp(qint64 ms) {
+    qint64 totalSecs = ms / 1000;
+    qint64 hours = totalSecs / 3600;
+    qint64 mins = (totalSecs / 60) % 60;
+    qint64 secs = totalSecs % 60;
+    if (hours > 0) {
+        return QString("%1:%2:%3").arg(hours).arg(mins, 2, 10, QChar('0')).arg(secs, 2, 10, QChar('0'));
+    }
+    return QString("%1:%2").arg(mins).arg(secs, 2, 10, QChar('0'));
+}
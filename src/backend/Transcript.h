@@ -0,0 +1,55 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Timed captions for one video: a flat, time-sorted segment array over a single text buffer,
+// plus an inverted token index (sorted terms -> segment postings) for instant in-video search
+class Transcript {
+public:
+    struct Segment {
+        qint32 startMs = 0;
+        qint32 durationMs = 0;
+        qint32 textOffset = 0;
+        qint32 textLength = 0;
+    };
+
+    // Accepts timed-text XML (srv1 <text start dur>, srv3 <p t d>) or WebVTT; format is sniffed
+    static Transcript parse(const QByteArray &data);
+    static Transcript loadFromFile(const QString &path);
+
+    bool isEmpty() const { return m_segments.isEmpty(); }
+    int size() const { return m_segments.size(); }
+    qint64 startMs(int index) const { return m_segments[index].startMs; }
+    qint64 endMs(int index) const { return m_segments[index].startMs + m_segments[index].durationMs; }
+    QString text(int index) const;
+    QString language() const { return m_language; }
+    void setLanguage(const QString &language) { m_language = language; }
+
+    // Segment showing at the given time (the last one starting at or before it), -1 before the first
+    int segmentAt(qint64 ms) const;
+
+    // Segments containing every query token; the last token matches as a prefix so results track typing
+    QVector<int> search(const QString &query, int limit = 500) const;
+
+    static QStringList tokenize(const QString &text);
+    static QString formatTimestamp(qint64 ms);
+
+private:
+    void append(qint64 startMs, qint64 durationMs, const QString &text);
+    void finalize();
+    QVector<int> postingsFor(const QString &term, bool prefix) const;
+
+    static Transcript parseXml(const QByteArray &data);
+    static Transcript parseVtt(const QByteArray &data);
+
+    QVector<Segment> m_segments;
+    QString m_text;
+    QString m_language;
+
+    // CSR layout: postings of m_terms[i] are m_postings[m_postingStarts[i] .. m_postingStarts[i + 1])
+    QStringList m_terms;
+    QVector<qint32> m_postingStarts;
+    QVector<qint32> m_postings;
+};
@@ -0,0 +1,467 @@
+#include "TranscriptIndex.h"
+#include "Log.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+const int TranscriptIndex::FLUSH_DOCS = 32;
+const int TranscriptIndex::MAX_SEGMENTS = 8;
+const int TranscriptIndex::MAX_HIT_TIMES = 8;
+
+namespace {
+
+using Posting = TranscriptIndex::Posting;
+using PostingSpan = TranscriptIndex::PostingSpan;
+
+const char SEGMENT_MAGIC[4] = {'Y', 'C', 'T', 'I'};
+const quint32 SEGMENT_VERSION = 1;
+
+// Segment file, native byte order (it is a local cache):
+//   FileHeader | TermEntry[termCount] sorted by hash | Posting[postingCount] | doc table
+// Postings of one term are sorted by (doc, startMs). The doc table is (u16 len, utf8) id/title pairs.
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 docCount;
+    quint32 termCount;
+    quint64 postingCount;
+    quint64 docTableOffset;
+};
+
+struct TermEntry {
+    quint64 hash;
+    quint64 first;
+    quint64 count;
+};
+
+using PostingSink = std::function<void(const Posting *begin, const Posting *end, quint32 docOffset)>;
+
+bool writeSegment(const QString &path, const QVector<TermEntry> &terms,
+                  const std::function<void(const PostingSink &)> &emitPostings,
+                  const QStringList &videoIds, const QStringList &titles) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(header.magic));
+    header.version = SEGMENT_VERSION;
+    header.docCount = videoIds.size();
+    header.termCount = terms.size();
+    header.postingCount = terms.isEmpty() ? 0 : terms.last().first + terms.last().count;
+    header.docTableOffset = sizeof(FileHeader) + sizeof(TermEntry) * header.termCount
+                            + sizeof(Posting) * header.postingCount;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(terms.constData()), sizeof(TermEntry) * terms.size());
+
+    QByteArray buffer;
+    buffer.reserve(1 << 20);
+    emitPostings([&](const Posting *begin, const Posting *end, quint32 docOffset) {
+        for (const Posting *p = begin; p < end; ++p) {
+            Posting out{p->doc + docOffset, p->startMs};
+            buffer.append(reinterpret_cast<const char *>(&out), sizeof(out));
+        }
+        if (buffer.size() >= (1 << 20)) {
+            file.write(buffer);
+            buffer.clear();
+        }
+    });
+    file.write(buffer);
+
+    auto writeString = [&file](const QString &value) {
+        QByteArray utf8 = value.toUtf8().left(std::numeric_limits<quint16>::max());
+        quint16 length = utf8.size();
+        file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        file.write(utf8);
+    };
+    for (int i = 0; i < videoIds.size(); ++i) {
+        writeString(videoIds[i]);
+        writeString(titles.value(i));
+    }
+
+    return file.commit();
+}
+
+// Videos present in every span; spans[0] must be the shortest
+void collectHits(const QVector<PostingSpan> &spans, const QStringList &videoIds, const QStringList &titles,
+                 QVector<TranscriptIndex::Hit> &hits) {
+    const PostingSpan &rarest = spans[0];
+    for (const Posting *p = rarest.begin; p < rarest.end;) {
+        quint32 doc = p->doc;
+        const Posting *docEnd = p;
+        while (docEnd < rarest.end && docEnd->doc == doc) ++docEnd;
+
+        int matches = docEnd - p;
+        bool inAll = true;
+        for (int k = 1; k < spans.size() && inAll; ++k) {
+            const Posting *lo = std::lower_bound(spans[k].begin, spans[k].end, doc,
+                                                 [](const Posting &a, quint32 d) { return a.doc < d; });
+            const Posting *hi = std::upper_bound(lo, spans[k].end, doc,
+                                                 [](quint32 d, const Posting &a) { return d < a.doc; });
+            inAll = lo != hi;
+            matches += hi - lo;
+        }
+
+        if (inAll && doc < static_cast<quint32>(videoIds.size())) {
+            TranscriptIndex::Hit hit;
+            hit.videoId = videoIds[doc];
+            hit.title = titles.value(doc);
+            hit.matches = matches;
+            for (const Posting *q = p; q < docEnd && hit.timesMs.size() < TranscriptIndex::MAX_HIT_TIMES; ++q) {
+                hit.timesMs.append(q->startMs);
+            }
+            hits.append(hit);
+        }
+        p = docEnd;
+    }
+}
+
+}
+
+class TranscriptIndex::Segment {
+public:
+    bool open(const QString &path);
+    PostingSpan lookup(quint64 hash) const;
+
+    QString path;
+    int sequence = 0;
+    QStringList videoIds;
+    QStringList titles;
+    const TermEntry *terms = nullptr;
+    quint32 termCount = 0;
+    const Posting *postings = nullptr;
+    quint64 postingCount = 0;
+
+private:
+    QFile m_file;
+};
+
+bool TranscriptIndex::Segment::open(const QString &filePath) {
+    path = filePath;
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(FileHeader))) return false;
+
+    const uchar *data = m_file.map(0, m_file.size());
+    if (!data) return false;
+    quint64 size = m_file.size();
+
+    const FileHeader *header = reinterpret_cast<const FileHeader *>(data);
+    if (std::memcmp(header->magic, SEGMENT_MAGIC, sizeof(header->magic)) != 0 || header->version != SEGMENT_VERSION) {
+        return false;
+    }
+    quint64 postingsOffset = sizeof(FileHeader) + sizeof(TermEntry) * quint64(header->termCount);
+    if (postingsOffset + sizeof(Posting) * header->postingCount != header->docTableOffset
+        || header->docTableOffset > size) {
+        return false;
+    }
+
+    terms = reinterpret_cast<const TermEntry *>(data + sizeof(FileHeader));
+    termCount = header->termCount;
+    postings = reinterpret_cast<const Posting *>(data + postingsOffset);
+    postingCount = header->postingCount;
+
+    quint64 offset = header->docTableOffset;
+    auto readString = [&](QString &out) {
+        if (offset + sizeof(quint16) > size) return false;
+        quint16 length;
+        std::memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if (offset + length > size) return false;
+        out = QString::fromUtf8(reinterpret_cast<const char *>(data + offset), length);
+        offset += length;
+        return true;
+    };
+    for (quint32 i = 0; i < header->docCount; ++i) {
+        QString id, title;
+        if (!readString(id) || !readString(title)) return false;
+        videoIds.append(id);
+        titles.append(title);
+    }
+    return true;
+}
+
+PostingSpan TranscriptIndex::Segment::lookup(quint64 hash) const {
+    const TermEntry *end = terms + termCount;
+    const TermEntry *it = std::lower_bound(terms, end, hash, [](const TermEntry &t, quint64 h) { return t.hash < h; });
+    if (it == end || it->hash != hash || it->first + it->count > postingCount) return {};
+    return {postings + it->first, postings + it->first + it->count};
+}
+
+TranscriptIndex::TranscriptIndex(const QString &directory)
+    : m_directory(directory)
+{
+    QDir().mkpath(m_directory);
+    loadSegments();
+}
+
+TranscriptIndex::~TranscriptIndex() {
+    flush();
+}
+
+QString TranscriptIndex::segmentPath(int sequence) const {
+    return QDir(m_directory).filePath(QString("seg-%1.ycti").arg(sequence, 8, 10, QChar('0')));
+}
+
+void TranscriptIndex::loadSegments() {
+    QStringList names = QDir(m_directory).entryList({"seg-*.ycti"}, QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        auto segment = QSharedPointer<Segment>::create();
+        segment->sequence = name.mid(4, 8).toInt();
+        m_nextSequence = std::max(m_nextSequence, segment->sequence + 1);
+        if (!segment->open(QDir(m_directory).filePath(name))) {
+            LOG_WARN("TranscriptIndex", "Dropping unreadable segment %s", name);
+            segment.reset();
+            QFile::remove(QDir(m_directory).filePath(name));
+            continue;
+        }
+        m_segments.append(segment);
+    }
+
+    // A merge interrupted before its inputs were deleted leaves them behind, fully covered by the output
+    QSet<QString> seen;
+    for (int i = m_segments.size() - 1; i >= 0; --i) {
+        const QStringList &ids = m_segments[i]->videoIds;
+        bool covered = !ids.isEmpty() && std::all_of(ids.begin(), ids.end(), [&seen](const QString &id) {
+            return seen.contains(id);
+        });
+        if (covered) {
+            QString path = m_segments[i]->path;
+            m_segments.removeAt(i);
+            QFile::remove(path);
+            continue;
+        }
+        for (const QString &id : ids) seen.insert(id);
+    }
+    m_videoIds = seen;
+
+    LOG_INFO("TranscriptIndex", "%d videos in %d segment(s)", (int)m_videoIds.size(), (int)m_segments.size());
+}
+
+bool TranscriptIndex::contains(const QString &videoId) const {
+    QReadLocker locker(&m_lock);
+    return m_videoIds.contains(videoId);
+}
+
+int TranscriptIndex::documentCount() const {
+    QReadLocker locker(&m_lock);
+    return m_videoIds.size();
+}
+
+quint64 TranscriptIndex::termHash(const QString &term) {
+    // FNV-1a; stable across runs, unlike qHash
+    quint64 hash = 1469598103934665603ULL;
+    for (QChar ch : term) {
+        hash ^= ch.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void TranscriptIndex::add(const QString &videoId, const QString &title, const Transcript &transcript) {
+    if (transcript.isEmpty() || contains(videoId)) return;
+
+    // Tokenize outside the lock; searches keep running meanwhile
+    QVector<QPair<quint64, quint32>> entries;
+    for (int i = 0; i < transcript.size(); ++i) {
+        QStringList tokens = Transcript::tokenize(transcript.text(i));
+        tokens.removeDuplicates();
+        for (const QString &token : tokens) {
+            entries.append({termHash(token), static_cast<quint32>(transcript.startMs(i))});
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    if (m_videoIds.contains(videoId)) return;
+
+    quint32 doc = m_deltaVideoIds.size();
+    for (const auto &entry : entries) {
+        m_deltaPostings[entry.first].append({doc, entry.second});
+    }
+    m_deltaVideoIds.append(videoId);
+    m_deltaTitles.append(title);
+    m_videoIds.insert(videoId);
+
+    if (m_deltaVideoIds.size() >= FLUSH_DOCS) {
+        flushLocked();
+    }
+}
+
+void TranscriptIndex::flush() {
+    QWriteLocker locker(&m_lock);
+    flushLocked();
+}
+
+void TranscriptIndex::flushLocked() {
+    if (m_deltaVideoIds.isEmpty()) return;
+
+    QVector<quint64> hashes = m_deltaPostings.keys();
+    std::sort(hashes.begin(), hashes.end());
+
+    QVector<TermEntry> terms;
+    terms.reserve(hashes.size());
+    quint64 first = 0;
+    for (quint64 hash : hashes) {
+        quint64 count = m_deltaPostings.value(hash).size();
+        terms.append({hash, first, count});
+        first += count;
+    }
+
+    int sequence = m_nextSequence++;
+    QString path = segmentPath(sequence);
+    bool written = writeSegment(path, terms, [&](const PostingSink &sink) {
+        for (quint64 hash : hashes) {
+            const QVector<Posting> &list = m_deltaPostings[hash];
+            sink(list.constData(), list.constData() + list.size(), 0);
+        }
+    }, m_deltaVideoIds, m_deltaTitles);
+
+    auto segment = QSharedPointer<Segment>::create();
+    segment->sequence = sequence;
+    if (!written || !segment->open(path)) {
+        // Keep the delta in memory; the next flush retries under a new name
+        LOG_WARN("TranscriptIndex", "Failed to write %s", path);
+        return;
+    }
+
+    LOG_INFO("TranscriptIndex", "Wrote segment %d: %d videos, %d terms", sequence, (int)m_deltaVideoIds.size(), (int)terms.size());
+
+    m_segments.append(segment);
+    m_deltaPostings.clear();
+    m_deltaVideoIds.clear();
+    m_deltaTitles.clear();
+
+    if (m_segments.size() > MAX_SEGMENTS) {
+        mergeLocked();
+    }
+}
+
+void TranscriptIndex::mergeLocked() {
+    // Merge the smallest half so large segments are rewritten rarely
+    QList<QSharedPointer<Segment>> bySize = m_segments;
+    std::sort(bySize.begin(), bySize.end(), [](const auto &a, const auto &b) {
+        return a->postingCount < b->postingCount;
+    });
+    int mergeCount = std::max(2, static_cast<int>(m_segments.size()) - MAX_SEGMENTS / 2);
+    QSet<Segment *> chosen;
+    for (int i = 0; i < mergeCount; ++i) chosen.insert(bySize[i].data());
+
+    // Inputs in sequence order; their docs are renumbered back to back
+    QList<QSharedPointer<Segment>> inputs;
+    QVector<quint32> docOffsets;
+    QStringList videoIds, titles;
+    for (const auto &segment : m_segments) {
+        if (!chosen.contains(segment.data())) continue;
+        inputs.append(segment);
+        docOffsets.append(videoIds.size());
+        videoIds += segment->videoIds;
+        titles += segment->titles;
+    }
+
+    // k-way walk over the hash-sorted term tables
+    QVector<TermEntry> terms;
+    QVector<quint32> cursor(inputs.size(), 0);
+    quint64 first = 0;
+    for (;;) {
+        quint64 minHash = std::numeric_limits<quint64>::max();
+        bool any = false;
+        for (int i = 0; i < inputs.size(); ++i) {
+            if (cursor[i] < inputs[i]->termCount) {
+                minHash = std::min(minHash, inputs[i]->terms[cursor[i]].hash);
+                any = true;
+            }
+        }
+        if (!any) break;
+
+        quint64 count = 0;
+        for (int i = 0; i < inputs.size(); ++i) {
+            if (cursor[i] < inputs[i]->termCount && inputs[i]->terms[cursor[i]].hash == minHash) {
+                count += inputs[i]->terms[cursor[i]].count;
+                ++cursor[i];
+            }
+        }
+        terms.append({minHash, first, count});
+        first += count;
+    }
+
+    int sequence = m_nextSequence++;
+    QString path = segmentPath(sequence);
+    bool written = writeSegment(path, terms, [&](const PostingSink &sink) {
+        std::fill(cursor.begin(), cursor.end(), 0);
+        for (const TermEntry &term : terms) {
+            for (int i = 0; i < inputs.size(); ++i) {
+                const Segment &input = *inputs[i];
+                if (cursor[i] < input.termCount && input.terms[cursor[i]].hash == term.hash) {
+                    const TermEntry &entry = input.terms[cursor[i]++];
+                    sink(input.postings + entry.first, input.postings + entry.first + entry.count, docOffsets[i]);
+                }
+            }
+        }
+    }, videoIds, titles);
+
+    auto merged = QSharedPointer<Segment>::create();
+    merged->sequence = sequence;
+    if (!written || !merged->open(path)) {
+        LOG_WARN("TranscriptIndex", "Merge into %s failed, keeping %d segments", path, (int)m_segments.size());
+        return;
+    }
+
+    QStringList obsolete;
+    for (const auto &input : inputs) {
+        obsolete.append(input->path);
+        m_segments.removeOne(input);
+    }
+    inputs.clear();
+    m_segments.append(merged);
+    // Unmapped now that the last references are gone
+    for (const QString &oldPath : obsolete) {
+        QFile::remove(oldPath);
+    }
+
+    LOG_INFO("TranscriptIndex", "Merged %d segments into %d (%d videos)", (int)obsolete.size(), sequence, (int)videoIds.size());
+}
+
+QVector<TranscriptIndex::Hit> TranscriptIndex::search(const QString &query, int limit) const {
+    QStringList tokens = Transcript::tokenize(query);
+    tokens.removeDuplicates();
+    if (tokens.isEmpty()) return {};
+
+    QVector<quint64> hashes;
+    for (const QString &token : tokens) hashes.append(termHash(token));
+
+    auto shortestFirst = [](const PostingSpan &a, const PostingSpan &b) { return a.size() < b.size(); };
+
+    QVector<Hit> hits;
+    QReadLocker locker(&m_lock);
+
+    for (const auto &segment : m_segments) {
+        QVector<PostingSpan> spans;
+        for (quint64 hash : hashes) {
+            PostingSpan span = segment->lookup(hash);
+            if (span.size() == 0) break;
+            spans.append(span);
+        }
+        if (spans.size() != hashes.size()) continue;
+        std::sort(spans.begin(), spans.end(), shortestFirst);
+        collectHits(spans, segment->videoIds, segment->titles, hits);
+    }
+
+    QVector<PostingSpan> deltaSpans;
+    for (quint64 hash : hashes) {
+        auto it = m_deltaPostings.constFind(hash);
+        if (it == m_deltaPostings.constEnd()) break;
+        deltaSpans.append({it->constData(), it->constData() + it->size()});
+    }
+    if (deltaSpans.size() == hashes.size()) {
+        std::sort(deltaSpans.begin(), deltaSpans.end(), shortestFirst);
+        collectHits(deltaSpans, m_deltaVideoIds, m_deltaTitles, hits);
+    }
+    locker.unlock();
+
+    std::sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) { return a.matches > b.matches; });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "Transcript.h"
+
+// Full-text index over every fetched transcript, kept on disk as immutable memory-mapped
+// segment files (term hash table -> postings of (video, timestamp)). New transcripts go to an
+// in-memory delta that is written out as a new segment every FLUSH_DOCS videos; small segments
+// are merged once there are more than MAX_SEGMENTS. All methods are thread-safe.
+class TranscriptIndex {
+public:
+    struct Hit {
+        QString videoId;
+        QString title;
+        int matches = 0;
+        // Caption start times for the rarest query term, earliest first
+        QVector<qint32> timesMs;
+    };
+
+    explicit TranscriptIndex(const QString &directory);
+    ~TranscriptIndex();
+
+    bool contains(const QString &videoId) const;
+    int documentCount() const;
+
+    void add(const QString &videoId, const QString &title, const Transcript &transcript);
+    void flush();
+
+    // Videos containing every query token (exact tokens, see Transcript::tokenize), most matches first
+    QVector<Hit> search(const QString &query, int limit = 50) const;
+
+    static quint64 termHash(const QString &term);
+
+    static const int FLUSH_DOCS;
+    static const int MAX_SEGMENTS;
+    static const int MAX_HIT_TIMES;
+
+    struct Posting {
+        quint32 doc;
+        quint32 startMs;
+    };
+    struct PostingSpan {
+        const Posting *begin = nullptr;
+        const Posting *end = nullptr;
+        qsizetype size() const { return end - begin; }
+    };
+    class Segment;
+
+private:
+    void loadSegments();
+    void flushLocked();
+    void mergeLocked();
+    QString segmentPath(int sequence) const;
+
+    QString m_directory;
+    mutable QReadWriteLock m_lock;
+    QList<QSharedPointer<Segment>> m_segments;
+    int m_nextSequence = 1;
+    QSet<QString> m_videoIds;
+
+    QHash<quint64, QVector<Posting>> m_deltaPostings;
+    QStringList m_deltaVideoIds;
+    QStringList m_deltaTitles;
+};
@@ -0,0 +1,270 @@
+#include "VideoIndex.h"
+#include "Transcript.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+const int VideoIndex::MAX_DOCUMENTS = 20000;
+const int VideoIndex::PREFIX_EXPANSIONS = 64;
+const double VideoIndex::PREFIX_WEIGHT = 0.8;
+const double VideoIndex::CHANNEL_WEIGHT = 0.6;
+const double VideoIndex::FUZZY_WEIGHT = 0.7;
+const double VideoIndex::MIN_FUZZY_SIMILARITY = 0.4;
+const int VideoIndex::MIN_FUZZY_LENGTH = 4;
+
+namespace {
+
+const quint32 FILE_MAGIC = 0x59435649; // "YCVI"
+const quint32 FILE_VERSION = 1;
+
+void insertSorted(QVector<int> &docs, int doc) {
+    auto it = std::lower_bound(docs.begin(), docs.end(), doc);
+    if (it == docs.end() || *it != doc) docs.insert(it, doc);
+}
+
+void eraseSorted(QVector<int> &docs, int doc) {
+    auto it = std::lower_bound(docs.begin(), docs.end(), doc);
+    if (it != docs.end() && *it == doc) docs.erase(it);
+}
+
+QStringList distinctTokens(const QString &text) {
+    QStringList tokens = Transcript::tokenize(text);
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+}
+
+VideoIndex VideoIndex::load(const QString &path) {
+    VideoIndex index;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return index;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0, version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != FILE_MAGIC || version != FILE_VERSION || count < 0) return index;
+
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        VideoResult vid;
+        quint64 viewCount = 0, likeCount = 0;
+        qint64 seenAt = 0;
+        in >> vid.id >> vid.title >> vid.channel >> vid.channelId >> vid.thumbnailUrl >> vid.publishedAt
+           >> viewCount >> likeCount >> vid.duration >> seenAt;
+        if (in.status() != QDataStream::Ok) break;
+        vid.viewCount = viewCount;
+        vid.likeCount = likeCount;
+        index.add(vid, seenAt);
+    }
+    return index;
+}
+
+bool VideoIndex::save(const QString &path, const QVector<Document> &documents) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << FILE_MAGIC << FILE_VERSION << qint32(documents.size());
+    for (const Document &doc : documents) {
+        const VideoResult &vid = doc.video;
+        out << vid.id << vid.title << vid.channel << vid.channelId << vid.thumbnailUrl << vid.publishedAt
+            << quint64(vid.viewCount) << quint64(vid.likeCount) << vid.duration << doc.seenAt;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+void VideoIndex::add(const VideoResult &video, qint64 seenAt) {
+    if (video.id.isEmpty()) return;
+
+    auto existing = m_documentIds.constFind(video.id);
+    if (existing == m_documentIds.constEnd()) {
+        m_documents.append({video, seenAt});
+        int doc = m_documents.size() - 1;
+        m_documentIds.insert(video.id, doc);
+        indexDocument(doc);
+        if (m_documents.size() > MAX_DOCUMENTS) evictOldest();
+        return;
+    }
+
+    int doc = *existing;
+    Document &stored = m_documents[doc];
+    bool retokenize = stored.video.title != video.title || stored.video.channel != video.channel;
+    if (retokenize) unindexDocument(doc);
+
+    // Snapshots and search pages don't always carry statistics; keep what we had
+    VideoResult merged = video;
+    if (merged.viewCount == 0) merged.viewCount = stored.video.viewCount;
+    if (merged.likeCount == 0) merged.likeCount = stored.video.likeCount;
+    if (merged.duration.isEmpty()) merged.duration = stored.video.duration;
+    if (merged.thumbnailUrl.isEmpty()) merged.thumbnailUrl = stored.video.thumbnailUrl;
+    stored.video = merged;
+    stored.seenAt = std::max(stored.seenAt, seenAt);
+
+    if (retokenize) indexDocument(doc);
+}
+
+void VideoIndex::addAll(const QList<VideoResult> &videos, qint64 seenAt) {
+    for (const auto &vid : videos) add(vid, seenAt);
+}
+
+void VideoIndex::updateStatistics(const VideoResult &video) {
+    auto existing = m_documentIds.constFind(video.id);
+    if (existing == m_documentIds.constEnd()) return;
+
+    VideoResult &stored = m_documents[*existing].video;
+    if (video.viewCount) stored.viewCount = video.viewCount;
+    if (video.likeCount) stored.likeCount = video.likeCount;
+    if (!video.duration.isEmpty()) stored.duration = video.duration;
+}
+
+const VideoResult *VideoIndex::find(const QString &videoId) const {
+    auto existing = m_documentIds.constFind(videoId);
+    return existing == m_documentIds.constEnd() ? nullptr : &m_documents[*existing].video;
+}
+
+QList<VideoResult> VideoIndex::search(const QString &query, int limit) const {
+    QStringList terms = Transcript::tokenize(query);
+    if (terms.isEmpty() || m_documents.isEmpty()) return {};
+
+    QHash<int, double> scores;
+    for (int i = 0; i < terms.size(); ++i) {
+        const QString &term = terms[i];
+        QHash<int, double> termScores;
+        auto credit = [&termScores](const Token &token, double weight) {
+            for (int doc : token.titleDocs) {
+                double &score = termScores[doc];
+                score = std::max(score, weight);
+            }
+            for (int doc : token.channelDocs) {
+                double &score = termScores[doc];
+                score = std::max(score, weight * CHANNEL_WEIGHT);
+            }
+        };
+
+        auto exact = m_vocabulary.constFind(term);
+        if (exact != m_vocabulary.constEnd()) credit(m_tokens[*exact], 1.0);
+
+        // The last token is usually still being typed
+        if (i == terms.size() - 1) {
+            int expanded = 0;
+            for (auto it = m_vocabulary.lowerBound(term);
+                 it != m_vocabulary.constEnd() && expanded < PREFIX_EXPANSIONS && it.key().startsWith(term); ++it) {
+                if (it.key().size() == term.size()) continue;
+                credit(m_tokens[*it], PREFIX_WEIGHT);
+                ++expanded;
+            }
+        }
+
+        if (term.size() >= MIN_FUZZY_LENGTH) {
+            QStringList grams = trigrams(term);
+            QHash<int, int> shared;
+            for (const QString &gram : grams) {
+                auto tokens = m_trigramTokens.constFind(gram);
+                if (tokens == m_trigramTokens.constEnd()) continue;
+                for (int token : *tokens) ++shared[token];
+            }
+            for (auto it = shared.constBegin(); it != shared.constEnd(); ++it) {
+                const Token &token = m_tokens[it.key()];
+                if (token.text == term) continue;
+                double similarity = 2.0 * it.value() / (grams.size() + token.trigramCount);
+                if (similarity >= MIN_FUZZY_SIMILARITY) credit(token, FUZZY_WEIGHT * similarity);
+            }
+        }
+
+        if (i == 0) {
+            scores = termScores;
+        } else {
+            for (auto it = scores.begin(); it != scores.end();) {
+                auto match = termScores.constFind(it.key());
+                if (match == termScores.constEnd()) {
+                    it = scores.erase(it);
+                } else {
+                    it.value() += *match;
+                    ++it;
+                }
+            }
+        }
+        if (scores.isEmpty()) return {};
+    }
+
+    QVector<QPair<int, double>> ranked;
+    ranked.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) ranked.append({it.key(), it.value()});
+    std::sort(ranked.begin(), ranked.end(), [this](const QPair<int, double> &a, const QPair<int, double> &b) {
+        if (a.second != b.second) return a.second > b.second;
+        const Document &da = m_documents[a.first];
+        const Document &db = m_documents[b.first];
+        if (da.video.viewCount != db.video.viewCount) return da.video.viewCount > db.video.viewCount;
+        return da.seenAt > db.seenAt;
+    });
+
+    QList<VideoResult> results;
+    for (int i = 0; i < ranked.size() && i < limit; ++i) {
+        results.append(m_documents[ranked[i].first].video);
+    }
+    return results;
+}
+
+QStringList VideoIndex::trigrams(const QString &token) {
+    // Padding lets short tokens and word boundaries contribute
+    QString padded = QChar('$') + token + QChar('$');
+    QStringList grams;
+    for (int i = 0; i + 3 <= padded.size(); ++i) grams.append(padded.mid(i, 3));
+    grams.removeDuplicates();
+    return grams;
+}
+
+int VideoIndex::tokenId(const QString &text) {
+    auto existing = m_vocabulary.constFind(text);
+    if (existing != m_vocabulary.constEnd()) return *existing;
+
+    int id = m_tokens.size();
+    Token token;
+    token.text = text;
+    QStringList grams = trigrams(text);
+    token.trigramCount = grams.size();
+    m_tokens.append(token);
+    m_vocabulary.insert(text, id);
+    for (const QString &gram : grams) m_trigramTokens[gram].append(id);
+    return id;
+}
+
+void VideoIndex::indexDocument(int doc) {
+    const VideoResult &vid = m_documents[doc].video;
+    for (const QString &term : distinctTokens(vid.title)) insertSorted(m_tokens[tokenId(term)].titleDocs, doc);
+    for (const QString &term : distinctTokens(vid.channel)) insertSorted(m_tokens[tokenId(term)].channelDocs, doc);
+}
+
+void VideoIndex::unindexDocument(int doc) {
+    // Emptied tokens stay in the vocabulary; they match nothing
+    const VideoResult &vid = m_documents[doc].video;
+    for (const QString &term : distinctTokens(vid.title)) {
+        auto id = m_vocabulary.constFind(term);
+        if (id != m_vocabulary.constEnd()) eraseSorted(m_tokens[*id].titleDocs, doc);
+    }
+    for (const QString &term : distinctTokens(vid.channel)) {
+        auto id = m_vocabulary.constFind(term);
+        if (id != m_vocabulary.constEnd()) eraseSorted(m_tokens[*id].channelDocs, doc);
+    }
+}
+
+void VideoIndex::evictOldest() {
+    // Drop a tenth at once so the rebuild happens once per MAX_DOCUMENTS / 10 new videos
+    QVector<Document> kept = m_documents;
+    std::sort(kept.begin(), kept.end(), [](const Document &a, const Document &b) { return a.seenAt > b.seenAt; });
+    kept.resize(MAX_DOCUMENTS - MAX_DOCUMENTS / 10);
+
+    m_documents.clear();
+    m_documentIds.clear();
+    m_tokens.clear();
+    m_vocabulary.clear();
+    m_trigramTokens.clear();
+    for (const Document &doc : kept) add(doc.video, doc.seenAt);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "VideoResult.h"
+
+// Title/channel search over every video the app has shown (search pages, feed, snapshot), so
+// the Search tab can answer before, or without, the network. Query tokens match the vocabulary
+// exactly, by prefix (last token only) or, for misspellings, by trigram similarity; every query
+// token has to match. Only the documents are persisted; postings are rebuilt on load.
+// Not thread-safe: load/save a copy on a worker, query on one thread.
+class VideoIndex {
+public:
+    struct Document {
+        VideoResult video;
+        // Seconds since the epoch; the least recently seen are evicted first
+        qint64 seenAt = 0;
+    };
+
+    // A missing, unreadable or older-format file gives an empty index
+    static VideoIndex load(const QString &path);
+    static bool save(const QString &path, const QVector<Document> &documents);
+
+    // Adds or refreshes the video; counts/duration it doesn't carry keep their stored values
+    void add(const VideoResult &video, qint64 seenAt);
+    void addAll(const QList<VideoResult> &videos, qint64 seenAt);
+    // Counts and duration only, e.g. from YouTubeService::videoStatisticsReady
+    void updateStatistics(const VideoResult &video);
+
+    // Best matches first; ties go to the more viewed, then the more recently seen video
+    QList<VideoResult> search(const QString &query, int limit = 20) const;
+
+    // Null when the video isn't indexed; invalidated by the next add
+    const VideoResult *find(const QString &videoId) const;
+
+    int size() const { return m_documents.size(); }
+    const QVector<Document> &documents() const { return m_documents; }
+
+    static const int MAX_DOCUMENTS;
+    static const int PREFIX_EXPANSIONS;
+    static const double PREFIX_WEIGHT;
+    static const double CHANNEL_WEIGHT;
+    static const double FUZZY_WEIGHT;
+    // Dice coefficient over padded trigrams
+    static const double MIN_FUZZY_SIMILARITY;
+    static const int MIN_FUZZY_LENGTH;
+
+private:
+    struct Token {
+        QString text;
+        // Ascending document numbers
+        QVector<int> titleDocs;
+        QVector<int> channelDocs;
+        int trigramCount = 0;
+    };
+
+    static QStringList trigrams(const QString &token);
+    int tokenId(const QString &text);
+    void indexDocument(int doc);
+    void unindexDocument(int doc);
+    void evictOldest();
+
+    QVector<Document> m_documents;
+    QHash<QString, int> m_documentIds;
+    QVector<Token> m_tokens;
+    // Sorted, for prefix ranges
+    QMap<QString, int> m_vocabulary;
+    QHash<QString, QVector<int>> m_trigramTokens;
+};
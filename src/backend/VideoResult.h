@@ -0,0 +1,15 @@
+#pragma once
+#include <QString>
+
+struct VideoResult {
+    QString id;
+    QString title;
+    QString channel;
+    QString channelId;
+    QString thumbnailUrl;
+    QString publishedAt;
+    
+    unsigned long long viewCount = 0;
+    unsigned long long likeCount = 0;
+    QString duration;
+};
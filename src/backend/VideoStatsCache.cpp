@@ -0,0 +1,64 @@
+#include "VideoStatsCache.h"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSet>
+
+const int VideoStatsCache::TTL_SECS = 60 * 60;
+const int VideoStatsCache::MAX_ENTRIES = 5000;
+const int VideoStatsCache::BATCH_SIZE = 50;
+
+VideoStatsCache::VideoStatsCache() {
+    m_entries.setMaxCost(MAX_ENTRIES);
+}
+
+QStringList VideoStatsCache::apply(QList<VideoResult> &videos, const QDateTime &now) {
+    QStringList missing;
+    QSet<QString> seen;
+    for (auto &vid : videos) {
+        if (vid.id.isEmpty()) continue;
+
+        const Entry *entry = m_entries.object(vid.id);
+        if (entry && entry->fetchedAt.secsTo(now) < TTL_SECS) {
+            vid.viewCount = entry->viewCount;
+            vid.likeCount = entry->likeCount;
+            vid.duration = entry->duration;
+        } else if (!seen.contains(vid.id)) {
+            seen.insert(vid.id);
+            missing.append(vid.id);
+        }
+    }
+    return missing;
+}
+
+void VideoStatsCache::insert(const QJsonDocument &response, const QStringList &requestedIds, const QDateTime &now) {
+    QSet<QString> unanswered(requestedIds.begin(), requestedIds.end());
+    for (const auto &item : response.object()["items"].toArray()) {
+        QJsonObject obj = item.toObject();
+        QString id = obj["id"].toString();
+        if (id.isEmpty()) continue;
+
+        QJsonObject stats = obj["statistics"].toObject();
+        auto *entry = new Entry;
+        entry->viewCount = stats["viewCount"].toString().toULongLong();
+        entry->likeCount = stats["likeCount"].toString().toULongLong();
+        entry->duration = obj["contentDetails"].toObject()["duration"].toString();
+        entry->fetchedAt = now;
+        m_entries.insert(id, entry, 1);
+        unanswered.remove(id);
+    }
+
+    for (const QString &id : unanswered) {
+        auto *entry = new Entry;
+        entry->fetchedAt = now;
+        m_entries.insert(id, entry, 1);
+    }
+    clearPending(requestedIds);
+}
+
+void VideoStatsCache::setPending(const QStringList &ids, int batch) {
+    for (const QString &id : ids) m_pending.insert(id, batch);
+}
+
+void VideoStatsCache::clearPending(const QStringList &ids) {
+    for (const QString &id : ids) m_pending.remove(id);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonDocument>
+#include <QList>
+#include <QStringList>
+#include "VideoResult.h"
+
+// View/like counts and durations from videos.list, by video id, shared by search and feed so
+// a video is looked up once per TTL whichever list it shows up in. Least recently used entries
+// are evicted past MAX_ENTRIES.
+class VideoStatsCache {
+public:
+    VideoStatsCache();
+
+    // Copies fresh statistics onto the videos; returns the ids (deduplicated) that have none
+    QStringList apply(QList<VideoResult> &videos, const QDateTime &now);
+    // Stores every item of a videos.list (part=statistics,contentDetails) response. Requested ids
+    // the response left out (private, deleted) are stored empty so they aren't asked for again.
+    void insert(const QJsonDocument &response, const QStringList &requestedIds, const QDateTime &now);
+
+    // In-flight requests, so overlapping lists (a search page and a feed refresh, a prefetched
+    // page) wait for the batch already asking for an id instead of asking again. insert() and
+    // clearPending() end a batch's ids.
+    void setPending(const QStringList &ids, int batch);
+    void clearPending(const QStringList &ids);
+    // The batch fetching the id, or -1
+    int pendingBatch(const QString &id) const { return m_pending.value(id, -1); }
+
+    int size() const { return m_entries.size(); }
+    void clear() { m_entries.clear(); }
+
+    // Counts drift, but not enough in an hour to reorder a feed
+    static const int TTL_SECS;
+    static const int MAX_ENTRIES;
+    // videos.list takes at most this many ids per call
+    static const int BATCH_SIZE;
+
+private:
+    struct Entry {
+        unsigned long long viewCount = 0;
+        unsigned long long likeCount = 0;
+        QString duration;
+        QDateTime fetchedAt;
+    };
+    QCache<QString, Entry> m_entries;
+    QHash<QString, int> m_pending;
+};
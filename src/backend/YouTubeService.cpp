@@ -1,279 +1,777 @@
 #include "YouTubeService.h"
+#include "Log.h"
+#include "GoogleAuth.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <QUrlQuery>
 #include <QDebug>
-#include <cstdio>
 #include <algorithm>
 
 #include <QSettings>
 #include <cmath>
+#include <memory>
 #include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QLocale>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentRun>
+
+const int YouTubeService::SEARCH_PAGE_SIZE = 25;
+const int YouTubeService::SEARCH_CACHE_ENTRIES = 50;
+const int YouTubeService::SEARCH_CACHE_TTL_SECS = 30 * 60;
+const int YouTubeService::SEARCH_HISTORY_LIMIT = 200;
+const int YouTubeService::TITLE_SUGGESTION_LIMIT = 2000;
+const int YouTubeService::FEED_CHANNEL_LIMIT = 20;
+const int YouTubeService::MAX_SUBSCRIPTION_PAGES = 200;
+const int YouTubeService::RECOMMENDATION_LIMIT = 60;
+
+namespace {
+const char *DEFAULT_API_BASE_URL = "https://www.googleapis.com/youtube/v3";
+
+// Trace names have to be literals
+const char *endpointTraceName(const QUrl &url) {
+    QString endpoint = url.path().section('/', -1);
+    if (endpoint == "subscriptions") return "subscriptions";
+    if (endpoint == "channels") return "channels";
+    if (endpoint == "playlistItems") return "playlistItems";
+    if (endpoint == "videos") return "videos";
+    return "api request";
+}
+
+// Data API units per call; search.list is the expensive one
+int quotaCost(const QUrl &url) {
+    return url.path().section('/', -1) == "search" ? 100 : 1;
+}
+}
 
 YouTubeService::YouTubeService(QObject *parent) : QObject(parent) {
     m_manager = new QNetworkAccessManager(this);
+    m_searchCache.setMaxCost(SEARCH_CACHE_ENTRIES);
     m_apiKey = qEnvironmentVariable("YOUTUBE_API_KEY");
+    setApiBaseUrl(qEnvironmentVariable("YOUTUBE_API_BASE_URL", DEFAULT_API_BASE_URL));
     loadSettings();
 }
 
+void YouTubeService::setApiBaseUrl(const QString &baseUrl) {
+    m_apiBaseUrl = baseUrl;
+    while (m_apiBaseUrl.endsWith('/')) m_apiBaseUrl.chop(1);
+}
+
+QUrl YouTubeService::apiUrl(const QString &endpoint) const {
+    return QUrl(m_apiBaseUrl + '/' + endpoint);
+}
+
+QNetworkReply *YouTubeService::sendGet(const QNetworkRequest &request, const char *traceName) {
+    QNetworkReply *reply = m_manager->get(request);
+    Trace::traceReply(reply, traceName);
+    Metrics::trackReply(reply);
+    if (request.url().toString().startsWith(m_apiBaseUrl)) {
+        static Metrics::Counter &quotaUnits = Metrics::counter("youtube.quota_units");
+        quotaUnits.add(quotaCost(request.url()));
+    }
+    return reply;
+}
+
 void YouTubeService::setAccessToken(const QString &token) {
     m_accessToken = token;
 }
 
-void YouTubeService::searchVideos(const QString &query) {
-    if (m_apiKey.isEmpty()) {
-        emit errorOccurred("API Key missing. Please set YOUTUBE_API_KEY.");
+void YouTubeService::setAuth(GoogleAuth *auth) {
+    if (m_auth) {
+        disconnect(m_auth, nullptr, this, nullptr);
+    }
+    m_auth = auth;
+    if (!m_auth) return;
+
+    connect(m_auth, &GoogleAuth::tokenRefreshed, this, &YouTubeService::replayPendingRequests);
+    connect(m_auth, &GoogleAuth::tokenRefreshFailed, this, &YouTubeService::failPendingRequests);
+    connect(m_auth, &GoogleAuth::loggedOut, this, &YouTubeService::failPendingRequests);
+}
+
+void YouTubeService::getAuthorized(const QUrl &url, std::function<void(QNetworkReply *)> onFinished, bool isRetry) {
+    // Don't spend a round trip on a token we already know is being replaced
+    if (m_auth && m_auth->isRefreshing() && !isRetry) {
+        m_pendingAuthRequests.append({url, onFinished, nullptr});
         return;
     }
 
-    QUrl url("https://www.googleapis.com/youtube/v3/search");
+    QNetworkRequest request(url);
+    if (!m_accessToken.isEmpty()) {
+        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_accessToken).toUtf8());
+    }
+
+    QNetworkReply *reply = sendGet(request, endpointTraceName(url));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, url, onFinished, isRetry]() {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 401 && m_auth && !isRetry) {
+            m_pendingAuthRequests.append({url, onFinished, reply});
+            m_auth->refreshAccessToken();
+            return;
+        }
+        onFinished(reply);
+    });
+}
+
+void YouTubeService::replayPendingRequests(const QString &accessToken) {
+    m_accessToken = accessToken;
+
+    QList<PendingRequest> pending;
+    pending.swap(m_pendingAuthRequests);
+    if (pending.isEmpty()) return;
+
+    LOG_INFO("YouTubeService", "Token refreshed, replaying %d request(s)", (int)pending.size());
+
+    for (const auto &req : pending) {
+        if (req.unauthorizedReply) {
+            req.unauthorizedReply->deleteLater();
+        }
+        getAuthorized(req.url, req.onFinished, true);
+    }
+}
+
+void YouTubeService::failPendingRequests() {
+    QList<PendingRequest> pending;
+    pending.swap(m_pendingAuthRequests);
+
+    for (const auto &req : pending) {
+        if (req.unauthorizedReply) {
+            // Hand the original 401 to its handler so the usual error path runs
+            req.onFinished(req.unauthorizedReply);
+        } else {
+            getAuthorized(req.url, req.onFinished, true);
+        }
+    }
+}
+
+QString YouTubeService::searchKey(const QString &query) {
+    return query.simplified().toLower();
+}
+
+void YouTubeService::cancelSearch() {
+    // finished() still fires on abort; the reply handlers drop replies that are no longer current
+    if (QNetworkReply *old = m_searchReply) {
+        m_searchReply = nullptr;
+        old->abort();
+    }
+    if (QNetworkReply *old = m_pageReply) {
+        m_pageReply = nullptr;
+        old->abort();
+    }
+    m_searchKey.clear();
+    m_searchQuery.clear();
+    m_appendNextPage = false;
+    m_searchCommitted = false;
+}
+
+QUrl YouTubeService::searchUrl(const QString &query, const QString &pageToken) const {
+    QUrl url = apiUrl("search");
     QUrlQuery q;
     q.addQueryItem("part", "snippet");
-    q.addQueryItem("maxResults", "25");
+    q.addQueryItem("maxResults", QString::number(SEARCH_PAGE_SIZE));
     q.addQueryItem("q", query);
     q.addQueryItem("type", "video");
+    if (!pageToken.isEmpty()) {
+        q.addQueryItem("pageToken", pageToken);
+    }
     q.addQueryItem("key", m_apiKey);
     url.setQuery(q);
+    return url;
+}
+
+void YouTubeService::searchVideos(const QString &query, bool committed) {
+    QString key = searchKey(query);
+    if (key.isEmpty()) return;
+    if (key == m_searchKey) {
+        // Typeahead already fetched it; committing is what makes the next page worth the quota
+        if (committed && !m_searchCommitted) {
+            m_searchCommitted = true;
+            prefetchNextSearchPage();
+        }
+        return;
+    }
+    cancelSearch();
+    m_searchCommitted = committed;
+
+    if (CachedSearch *cached = m_searchCache.object(key)) {
+        if (cached->fetchedAt.secsTo(QDateTime::currentDateTimeUtc()) < SEARCH_CACHE_TTL_SECS) {
+            static Metrics::Counter &hits = Metrics::counter("cache.search.hits");
+            hits.add();
+            m_searchKey = key;
+            m_searchQuery = query.simplified();
+            enrichSearchResults(cached->results);
+            QList<VideoResult> results = cached->results;
+            emit searchResultsReady(results);
+            if (m_searchCommitted) prefetchNextSearchPage();
+            return;
+        }
+        m_searchCache.remove(key);
+    }
+
+    if (m_apiKey.isEmpty()) {
+        emit searchFailed("API Key missing. Please set YOUTUBE_API_KEY.");
+        return;
+    }
 
-    QNetworkReply *reply = m_manager->get(QNetworkRequest(url));
+    static Metrics::Counter &misses = Metrics::counter("cache.search.misses");
+    misses.add();
+    m_searchKey = key;
+    m_searchQuery = query.simplified();
+    QNetworkReply *reply = sendGet(QNetworkRequest(searchUrl(m_searchQuery, QString())), "search");
+    m_searchReply = reply;
     connect(reply, &QNetworkReply::finished, this, [this, reply](){
         this->onSearchReply(reply);
     });
 }
 
+bool YouTubeService::hasMoreSearchResults() const {
+    const CachedSearch *cached = m_searchCache.object(m_searchKey);
+    if (!cached) return false;
+    return cached->hasPrefetched ? !cached->prefetchedPage.isEmpty() : !cached->nextPageToken.isEmpty();
+}
+
+void YouTubeService::fetchMoreSearchResults() {
+    CachedSearch *cached = m_searchCache.object(m_searchKey);
+    if (!cached || m_searchReply) return;
+
+    if (cached->hasPrefetched) {
+        promotePrefetchedPage(cached);
+        return;
+    }
+    // Scrolled to the end before the prefetch landed: show the page as soon as it does
+    m_appendNextPage = true;
+    prefetchNextSearchPage();
+}
+
+void YouTubeService::prefetchNextSearchPage() {
+    CachedSearch *cached = m_searchCache.object(m_searchKey);
+    if (!cached || cached->hasPrefetched || cached->nextPageToken.isEmpty() || m_pageReply || m_apiKey.isEmpty()) {
+        return;
+    }
+
+    QNetworkReply *reply = sendGet(QNetworkRequest(searchUrl(m_searchQuery, cached->nextPageToken)), "search page");
+    m_pageReply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key = m_searchKey]() {
+        onSearchPageReply(reply, key);
+    });
+}
+
+void YouTubeService::onSearchPageReply(QNetworkReply *reply, const QString &key) {
+    reply->deleteLater();
+    if (reply != m_pageReply) return;
+    m_pageReply = nullptr;
+
+    CachedSearch *cached = m_searchCache.object(key);
+    if (!cached) return;
+
+    if (reply->error()) {
+        if (m_appendNextPage) {
+            m_appendNextPage = false;
+            emit searchFailed("Network Error: " + reply->errorString());
+        }
+        return;
+    }
+
+    {
+        TRACE_SCOPE("parse", "search page response");
+        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+        cached->prefetchedPage = parseVideosFromJson(doc);
+        cached->prefetchedNextToken = doc.object()["nextPageToken"].toString();
+    }
+    cached->hasPrefetched = true;
+    addTitleSuggestions(cached->prefetchedPage);
+    // Usually back before the page is shown
+    enrichSearchResults(cached->prefetchedPage);
+
+    if (m_appendNextPage) {
+        promotePrefetchedPage(cached);
+    }
+}
+
+void YouTubeService::promotePrefetchedPage(CachedSearch *cached) {
+    // Search pages overlap now and then; don't show a video twice
+    QSet<QString> shown;
+    for (const auto &vid : cached->results) shown.insert(vid.id);
+    QList<VideoResult> page;
+    for (const auto &vid : cached->prefetchedPage) {
+        if (!shown.contains(vid.id)) page.append(vid);
+    }
+    m_videoStats.apply(page, QDateTime::currentDateTimeUtc());
+    m_recommender.addCandidates(page);
+
+    cached->results += page;
+    cached->nextPageToken = cached->prefetchedNextToken;
+    cached->prefetchedPage.clear();
+    cached->prefetchedNextToken.clear();
+    cached->hasPrefetched = false;
+    m_appendNextPage = false;
+
+    emit searchResultsAppended(page);
+    prefetchNextSearchPage();
+}
+
+void YouTubeService::recordSearch(const QString &query) {
+    QString text = query.simplified();
+    // Repeating the latest query changes nothing worth a settings write
+    if (text.isEmpty() || (!m_searchHistory.isEmpty() && m_searchHistory.first() == text)) return;
+
+    m_searchHistory.removeAll(text);
+    m_searchHistory.prepend(text);
+    while (m_searchHistory.size() > SEARCH_HISTORY_LIMIT) {
+        QString evicted = m_searchHistory.takeLast();
+        // The trie is case-insensitive; another spelling may still be in the history
+        if (!m_searchHistory.contains(evicted, Qt::CaseInsensitive)) m_suggestions.remove(evicted);
+    }
+    // Past queries always outrank titles (weight < 1); later ones outrank earlier ones
+    m_suggestions.insert(text, 2.0 + ++m_searchSequence);
+
+    QSettings settings("YouCpp", "YouCpp");
+    settings.setValue("search/history", m_searchHistory);
+}
+
+QStringList YouTubeService::searchSuggestions(const QString &prefix, int limit) const {
+    return m_suggestions.complete(prefix, limit);
+}
+
+void YouTubeService::addTitleSuggestions(const QList<VideoResult> &results) {
+    for (int i = 0; i < results.size(); ++i) {
+        // Higher-ranked results first among titles
+        m_suggestions.insert(results[i].title, 1.0 - (i + 1) / double(results.size() + 1));
+
+        QString key = results[i].title.simplified().toLower();
+        if (key.isEmpty() || m_titleSuggestionKeys.contains(key)) continue;
+        m_titleSuggestionKeys.insert(key);
+        m_titleSuggestions.enqueue(results[i].title);
+    }
+
+    // Paging through a long session would otherwise grow the trie without bound
+    while (m_titleSuggestions.size() > TITLE_SUGGESTION_LIMIT) {
+        QString evicted = m_titleSuggestions.dequeue();
+        m_titleSuggestionKeys.remove(evicted.simplified().toLower());
+        // A title the user also searched for stays as history
+        if (!m_searchHistory.contains(evicted.simplified(), Qt::CaseInsensitive)) m_suggestions.remove(evicted);
+    }
+}
+
 void YouTubeService::fetchSubscriptionsFeed() {
     if (m_accessToken.isEmpty()) {
         emit errorOccurred("Not authenticated. Please sign in first.");
         return;
     }
 
-    printf("[YouTubeService] Fetching subscriptions...\n");
-    fflush(stdout);
+    LOG_INFO("YouTubeService", "Fetching subscriptions...");
 
+    ++m_feedGeneration;
     m_pendingFeedRequests = 0;
     m_accumulatedFeedResults.clear();
+    m_feedChannelIds.clear();
+    m_feedChannelsRequested = false;
+    fetchSubscriptionPage(QString(), 1);
+}
 
-    QUrl url("https://www.googleapis.com/youtube/v3/subscriptions");
+void YouTubeService::fetchSubscriptionPage(const QString &pageToken, int page) {
+    QUrl url = apiUrl("subscriptions");
     QUrlQuery q;
     q.addQueryItem("part", "snippet");
     q.addQueryItem("mine", "true");
     q.addQueryItem("maxResults", "50");
+    if (!pageToken.isEmpty()) {
+        q.addQueryItem("pageToken", pageToken);
+    }
     url.setQuery(q);
 
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_accessToken).toUtf8());
+    int generation = m_feedGeneration;
+    getAuthorized(url, [this, generation, page](QNetworkReply *reply) {
+        reply->deleteLater();
+        if (generation != m_feedGeneration) return;
 
-    QNetworkReply *reply = m_manager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         if (reply->error()) {
-            printf("[YouTubeService] Subscriptions ERROR: %s\n", reply->errorString().toUtf8().constData());
-            emit errorOccurred("Failed to fetch subscriptions: " + reply->errorString());
-            reply->deleteLater();
+            LOG_ERROR("YouTubeService", "Subscriptions ERROR: %s", reply->errorString());
+            // Past the first FEED_CHANNEL_LIMIT channels only the subscribed set is incomplete
+            if (!m_feedChannelsRequested) {
+                emit errorOccurred("Failed to fetch subscriptions: " + reply->errorString());
+            } else {
+                emit subscriptionsLoaded(m_feedChannelIds.size());
+            }
             return;
         }
 
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        QJsonArray items = doc.object()["items"].toArray();
-        
-        printf("[YouTubeService] Found %d subscriptions\n", items.size());
-        fflush(stdout);
-        
-        QStringList channelIds;
-        for (const auto &item : items) {
-            QString channelId = item.toObject()["snippet"].toObject()
-                               ["resourceId"].toObject()["channelId"].toString();
-            if (!channelId.isEmpty()) {
-                channelIds.append(channelId);
+        QJsonObject root;
+        {
+            TRACE_SCOPE("parse", "subscriptions page");
+            root = QJsonDocument::fromJson(reply->readAll()).object();
+            for (const auto &item : root["items"].toArray()) {
+                QString channelId = item.toObject()["snippet"].toObject()
+                                   ["resourceId"].toObject()["channelId"].toString();
+                if (!channelId.isEmpty()) {
+                    m_feedChannelIds.append(channelId);
+                }
             }
         }
-        reply->deleteLater();
 
-        if (channelIds.isEmpty()) {
-            emit subscriptionFeedReady({});
+        // The feed only needs its first FEED_CHANNEL_LIMIT unmuted channels; start it as soon as
+        // they are known and keep paging for the full subscribed set in the background
+        if (!m_feedChannelsRequested) {
+            int unmuted = std::count_if(m_feedChannelIds.begin(), m_feedChannelIds.end(),
+                                        [this](const QString &id) { return !m_mutedChannelIds.contains(id); });
+            if (unmuted >= FEED_CHANNEL_LIMIT) {
+                m_feedChannelsRequested = true;
+                fetchFeedChannels();
+            }
+        }
+
+        QString next = root["nextPageToken"].toString();
+        if (!next.isEmpty() && page < MAX_SUBSCRIPTION_PAGES) {
+            fetchSubscriptionPage(next, page + 1);
             return;
         }
 
-        QUrl channelsUrl("https://www.googleapis.com/youtube/v3/channels");
-        QUrlQuery cq;
-        cq.addQueryItem("part", "contentDetails");
-        cq.addQueryItem("id", channelIds.join(","));
-        cq.addQueryItem("maxResults", "50");
-        if (!m_apiKey.isEmpty()) {
-            cq.addQueryItem("key", m_apiKey);
+        LOG_INFO("YouTubeService", "Found %d subscriptions", (int)m_feedChannelIds.size());
+        m_recommender.setSubscribedChannels(m_feedChannelIds);
+        saveSettings();
+        emit subscriptionsLoaded(m_feedChannelIds.size());
+        if (!m_feedChannelsRequested) {
+            m_feedChannelsRequested = true;
+            fetchFeedChannels();
         }
-        channelsUrl.setQuery(cq);
+    });
+}
 
-        QNetworkRequest channelsRequest(channelsUrl);
-        channelsRequest.setRawHeader("Authorization", QString("Bearer %1").arg(m_accessToken).toUtf8());
+void YouTubeService::fetchFeedChannels() {
+    // Muted channels don't take one of the feed's channel slots
+    QStringList channelIds;
+    for (const QString &id : m_feedChannelIds) {
+        if (m_mutedChannelIds.contains(id)) continue;
+        channelIds.append(id);
+        if (channelIds.size() >= FEED_CHANNEL_LIMIT) break;
+    }
 
-        QNetworkReply *channelsReply = m_manager->get(channelsRequest);
-        connect(channelsReply, &QNetworkReply::finished, this, [this, channelsReply]() {
-            if (channelsReply->error()) {
-                printf("[YouTubeService] Channels ERROR: %s\n", channelsReply->errorString().toUtf8().constData());
-                emit errorOccurred("Failed to fetch channel details");
-                channelsReply->deleteLater();
-                return;
-            }
+    if (channelIds.isEmpty()) {
+        emit subscriptionFeedReady({});
+        return;
+    }
 
-            QJsonDocument colDoc = QJsonDocument::fromJson(channelsReply->readAll());
-            QJsonArray channels = colDoc.object()["items"].toArray();
-            
-            QStringList uploadPlaylistIds;
-            for (const auto &item : channels) {
-                QString playlistId = item.toObject()["contentDetails"].toObject()
-                                        ["relatedPlaylists"].toObject()["uploads"].toString();
-                if (!playlistId.isEmpty()) {
-                    uploadPlaylistIds.append(playlistId);
-                }
-            }
-            channelsReply->deleteLater();
-            
-            printf("[YouTubeService] Found %d upload playlists. Fetching videos...\n", uploadPlaylistIds.size());
-            fflush(stdout);
+    QUrl channelsUrl = apiUrl("channels");
+    QUrlQuery cq;
+    cq.addQueryItem("part", "contentDetails");
+    cq.addQueryItem("id", channelIds.join(","));
+    cq.addQueryItem("maxResults", "50");
+    if (!m_apiKey.isEmpty()) {
+        cq.addQueryItem("key", m_apiKey);
+    }
+    channelsUrl.setQuery(cq);
 
-            if (uploadPlaylistIds.isEmpty()) {
-                emit subscriptionFeedReady({});
-                return;
+    int generation = m_feedGeneration;
+    getAuthorized(channelsUrl, [this, generation](QNetworkReply *channelsReply) {
+        channelsReply->deleteLater();
+        if (generation != m_feedGeneration) return;
+
+        if (channelsReply->error()) {
+            LOG_ERROR("YouTubeService", "Channels ERROR: %s", channelsReply->errorString());
+            emit errorOccurred("Failed to fetch channel details");
+            return;
+        }
+
+        QJsonDocument colDoc = QJsonDocument::fromJson(channelsReply->readAll());
+        QJsonArray channels = colDoc.object()["items"].toArray();
+
+        QStringList uploadPlaylistIds;
+        for (const auto &item : channels) {
+            QString playlistId = item.toObject()["contentDetails"].toObject()
+                                    ["relatedPlaylists"].toObject()["uploads"].toString();
+            if (!playlistId.isEmpty()) {
+                uploadPlaylistIds.append(playlistId);
             }
+        }
+
+        LOG_INFO("YouTubeService", "Found %d upload playlists. Fetching videos...", uploadPlaylistIds.size());
 
-            int limit = std::min((int)uploadPlaylistIds.size(), 20);
-            m_pendingFeedRequests = limit;
-            
-            for (int i = 0; i < limit; ++i) {
-                QUrl playlistUrl("https://www.googleapis.com/youtube/v3/playlistItems");
-                QUrlQuery pq;
-                pq.addQueryItem("part", "snippet");
-                pq.addQueryItem("playlistId", uploadPlaylistIds[i]);
-                pq.addQueryItem("maxResults", "5");
-                if (!m_apiKey.isEmpty()) {
-                    pq.addQueryItem("key", m_apiKey);
+        if (uploadPlaylistIds.isEmpty()) {
+            emit subscriptionFeedReady({});
+            return;
+        }
+
+        m_pendingFeedRequests = uploadPlaylistIds.size();
+        for (const QString &playlistId : uploadPlaylistIds) {
+            fetchFeedPlaylist(playlistId, generation);
+        }
+    });
+}
+
+void YouTubeService::fetchFeedPlaylist(const QString &playlistId, int generation) {
+    QUrl playlistUrl = apiUrl("playlistItems");
+    QUrlQuery pq;
+    pq.addQueryItem("part", "snippet");
+    pq.addQueryItem("playlistId", playlistId);
+    pq.addQueryItem("maxResults", "5");
+    if (!m_apiKey.isEmpty()) {
+        pq.addQueryItem("key", m_apiKey);
+    }
+    playlistUrl.setQuery(pq);
+
+    getAuthorized(playlistUrl, [this, generation](QNetworkReply *plReply) {
+        plReply->deleteLater();
+        if (generation != m_feedGeneration) return;
+
+        if (plReply->error() == QNetworkReply::NoError) {
+            TRACE_SCOPE("parse", "playlistItems");
+            QJsonDocument plDoc = QJsonDocument::fromJson(plReply->readAll());
+            QJsonArray plItems = plDoc.object()["items"].toArray();
+
+            for (const auto &item : plItems) {
+                QJsonObject snip = item.toObject()["snippet"].toObject();
+                VideoResult vid;
+                vid.id = snip["resourceId"].toObject()["videoId"].toString();
+                vid.title = snip["title"].toString();
+                vid.channel = snip["channelTitle"].toString();
+                vid.channelId = snip["channelId"].toString();
+                vid.thumbnailUrl = snip["thumbnails"].toObject()["medium"].toObject()["url"].toString();
+                vid.publishedAt = snip["publishedAt"].toString();
+
+                bool isMuted = m_mutedChannelIds.contains(vid.channelId);
+                if (!vid.title.contains("Private video") && !vid.title.contains("Deleted video") && !isMuted) {
+                    m_accumulatedFeedResults.append(vid);
                 }
-                playlistUrl.setQuery(pq);
-
-                QNetworkRequest plRequest(playlistUrl);
-                plRequest.setRawHeader("Authorization", QString("Bearer %1").arg(m_accessToken).toUtf8());
-                
-                QNetworkReply *plReply = m_manager->get(plRequest);
-                connect(plReply, &QNetworkReply::finished, this, [this, plReply]() {
-                    if (plReply->error() == QNetworkReply::NoError) {
-                        QJsonDocument plDoc = QJsonDocument::fromJson(plReply->readAll());
-                        QJsonArray plItems = plDoc.object()["items"].toArray();
-                        
-                        for (const auto &item : plItems) {
-                            QJsonObject snip = item.toObject()["snippet"].toObject();
-                            VideoResult vid;
-                            vid.id = snip["resourceId"].toObject()["videoId"].toString();
-                            vid.title = snip["title"].toString();
-                            vid.channel = snip["channelTitle"].toString();
-                            vid.channelId = snip["channelId"].toString();
-                            vid.thumbnailUrl = snip["thumbnails"].toObject()["medium"].toObject()["url"].toString();
-                            vid.publishedAt = snip["publishedAt"].toString();
-                            
-                            bool isMuted = m_mutedChannelIds.contains(vid.channelId);
-                            if (!vid.title.contains("Private video") && !vid.title.contains("Deleted video") && !isMuted) {
-                                m_accumulatedFeedResults.append(vid);
-                            }
-                        }
-                    } else {
-                        printf("[YouTubeService] Playlist fetch error: %s\n", plReply->errorString().toUtf8().constData());
-                    }
-                    plReply->deleteLater();
-                    
-                    m_pendingFeedRequests--;
-                    if (m_pendingFeedRequests <= 0) {
-                        QStringList batchIds;
-                        for(const auto &v : m_accumulatedFeedResults) {
-                            batchIds.append(v.id);
-                        }
-                        
-                        
-                        fetchVideoStatistics(batchIds);
-                    }
-                });
             }
-        });
+        } else {
+            LOG_WARN("YouTubeService", "Playlist fetch error: %s", plReply->errorString());
+        }
+
+        m_pendingFeedRequests--;
+        if (m_pendingFeedRequests <= 0) {
+            QStringList missing = applyCachedStatistics(m_accumulatedFeedResults);
+            fetchVideoStatistics(missing, [this, generation]() {
+                if (generation != m_feedGeneration) return;
+
+                m_videoStats.apply(m_accumulatedFeedResults, QDateTime::currentDateTimeUtc());
+                sortBySmartScore(m_accumulatedFeedResults, QDateTime::currentDateTime());
+                LOG_INFO("YouTubeService", "Smart sorted %d videos", m_accumulatedFeedResults.size());
+                addTitleSuggestions(m_accumulatedFeedResults);
+                m_recommender.addCandidates(m_accumulatedFeedResults);
+                emit subscriptionFeedReady(m_accumulatedFeedResults);
+            });
+        }
     });
 }
 
 void YouTubeService::fetchRecommendations() {
-    if (m_accessToken.isEmpty()) {
-        emit errorOccurred("Not authenticated. Please sign in first.");
-        return;
+    static Metrics::Histogram &rankUs = Metrics::histogram("recommendations.rank_us");
+    static Metrics::Gauge &candidates = Metrics::gauge("recommendations.candidates");
+
+    QList<VideoResult> results;
+    {
+        TRACE_SCOPE("rank", "recommendations");
+        QElapsedTimer timer;
+        timer.start();
+        results = m_recommender.recommend(RECOMMENDATION_LIMIT, QDateTime::currentDateTimeUtc(), m_mutedChannelIds);
+        rankUs.record(timer.nsecsElapsed() / 1000);
     }
+    candidates.set(m_recommender.candidateCount());
+    emit recommendationsReady(results);
+}
 
-    emit recommendationsReady({});
+void YouTubeService::recordWatch(const QString &videoId, const QString &channelId) {
+    m_recommender.recordWatch({videoId, channelId, QDateTime::currentSecsSinceEpoch()});
+    saveSettings();
 }
 
-void YouTubeService::fetchVideoStatistics(QList<QString> videoIds) {
-    if (videoIds.isEmpty()) {
-        emit subscriptionFeedReady(m_accumulatedFeedResults);
+void YouTubeService::addRecommendationCandidates(const QList<VideoResult> &videos) {
+    m_recommender.addCandidates(videos);
+}
+
+void YouTubeService::fetchTranscript(const QString &videoId) {
+    // The id ends up in a fixture path and a query string; anything else is a bug or hostile
+    static const QRegularExpression validId("^[A-Za-z0-9_-]{1,64}$");
+    if (!validId.match(videoId).hasMatch()) {
+        emit transcriptUnavailable(videoId, "Invalid video id");
         return;
     }
 
-    if (videoIds.size() > 50) videoIds = videoIds.mid(0, 50);
+    QString fixtureDir = qEnvironmentVariable("YOUCPP_CAPTION_DIR");
+    if (!fixtureDir.isEmpty()) {
+        for (const char *ext : {".vtt", ".xml"}) {
+            QString path = QDir(fixtureDir).filePath(videoId + ext);
+            if (QFile::exists(path)) {
+                parseTranscriptAsync(videoId, [path]() { return Transcript::loadFromFile(path); });
+                return;
+            }
+        }
+    }
 
-    QUrl url("https://www.googleapis.com/youtube/v3/videos");
-    QUrlQuery q;
-    q.addQueryItem("part", "statistics,contentDetails");
-    q.addQueryItem("id", videoIds.join(","));
-    if (!m_apiKey.isEmpty()) {
-        q.addQueryItem("key", m_apiKey);
+    QUrl url("https://www.youtube.com/api/timedtext");
+    QUrlQuery query;
+    query.addQueryItem("type", "list");
+    query.addQueryItem("v", videoId);
+    url.setQuery(query);
+
+    QNetworkReply *reply = sendGet(QNetworkRequest(url), "caption tracks");
+    connect(reply, &QNetworkReply::finished, this, [this, reply, videoId]() {
+        fetchTranscriptTrack(videoId, reply);
+    });
+}
+
+void YouTubeService::fetchTranscriptTrack(const QString &videoId, QNetworkReply *listReply) {
+    listReply->deleteLater();
+    if (listReply->error() != QNetworkReply::NoError) {
+        emit transcriptUnavailable(videoId, listReply->errorString());
+        return;
     }
-    url.setQuery(q);
 
-    QNetworkRequest request(url);
-    if (!m_accessToken.isEmpty()) {
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_accessToken).toUtf8());
+    struct Track {
+        QString lang;
+        QString name;
+        bool autoGenerated;
+    };
+    QList<Track> tracks;
+    QXmlStreamReader xml(listReply->readAll());
+    while (!xml.atEnd()) {
+        if (xml.readNext() == QXmlStreamReader::StartElement && xml.name() == u"track") {
+            QXmlStreamAttributes attrs = xml.attributes();
+            tracks.append({attrs.value("lang_code").toString(), attrs.value("name").toString(),
+                           attrs.value("kind") == u"asr"});
+        }
+    }
+    if (tracks.isEmpty()) {
+        emit transcriptUnavailable(videoId, "No captions for this video");
+        return;
     }
 
-    QNetworkReply *reply = m_manager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, videoIds]() {
-        if (reply->error()) {
-            printf("[YouTubeService] Stats fetch error: %s\n", reply->errorString().toUtf8().constData());
-            emit subscriptionFeedReady(m_accumulatedFeedResults);
+    // UI language first, then English; uploaded captions beat auto-generated ones
+    QString uiLang = QLocale::system().name().section('_', 0, 0);
+    auto score = [&uiLang](const Track &t) {
+        QString base = t.lang.section('-', 0, 0);
+        int s = base == uiLang ? 4 : (base == "en" ? 2 : 0);
+        return s + (t.autoGenerated ? 0 : 1);
+    };
+    Track best = *std::max_element(tracks.begin(), tracks.end(), [&score](const Track &a, const Track &b) {
+        return score(a) < score(b);
+    });
+
+    QUrl url("https://www.youtube.com/api/timedtext");
+    QUrlQuery query;
+    query.addQueryItem("v", videoId);
+    query.addQueryItem("lang", best.lang);
+    query.addQueryItem("fmt", "vtt");
+    if (!best.name.isEmpty()) query.addQueryItem("name", best.name);
+    if (best.autoGenerated) query.addQueryItem("kind", "asr");
+    url.setQuery(query);
+
+    QNetworkReply *reply = sendGet(QNetworkRequest(url), "captions");
+    connect(reply, &QNetworkReply::finished, this, [this, reply, videoId, lang = best.lang]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            emit transcriptUnavailable(videoId, reply->errorString());
+            return;
+        }
+        QByteArray data = reply->readAll();
+        parseTranscriptAsync(videoId, [data, lang]() {
+            Transcript transcript = Transcript::parse(data);
+            transcript.setLanguage(lang);
+            return transcript;
+        });
+    });
+}
+
+void YouTubeService::parseTranscriptAsync(const QString &videoId, std::function<Transcript()> work) {
+    // Multi-hour tracks are tens of thousands of cues; parse and index them off the UI thread
+    auto *watcher = new QFutureWatcher<Transcript>(this);
+    connect(watcher, &QFutureWatcher<Transcript>::finished, this, [this, watcher, videoId]() {
+        Transcript transcript = watcher->result();
+        watcher->deleteLater();
+        if (transcript.isEmpty()) {
+            emit transcriptUnavailable(videoId, "Captions are empty or unreadable");
+            return;
+        }
+        LOG_INFO("YouTubeService", "Transcript for %s: %d segments", videoId, transcript.size());
+        emit transcriptReady(videoId, transcript);
+    });
+    watcher->setFuture(QtConcurrent::run(work));
+}
+
+QStringList YouTubeService::applyCachedStatistics(QList<VideoResult> &videos) {
+    static Metrics::Counter &hits = Metrics::counter("cache.video_stats.hits");
+    static Metrics::Counter &misses = Metrics::counter("cache.video_stats.misses");
+    QStringList missing = m_videoStats.apply(videos, QDateTime::currentDateTimeUtc());
+    hits.add(videos.size() - missing.size());
+    misses.add(missing.size());
+    return missing;
+}
+
+void YouTubeService::fetchVideoStatistics(const QStringList &videoIds, std::function<void()> done) {
+    if (videoIds.isEmpty()) {
+        done();
+        return;
+    }
+
+    // Ids another list is already fetching are waited for, not requested again
+    QStringList unrequested;
+    QSet<int> joined;
+    for (const QString &id : videoIds) {
+        int pending = m_videoStats.pendingBatch(id);
+        if (pending < 0) {
+            unrequested.append(id);
         } else {
-            QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-            QJsonArray items = doc.object()["items"].toArray();
-            
-            QMap<QString, QJsonObject> statsMap;
-            for(const auto &item : items) {
-                QJsonObject obj = item.toObject();
-                statsMap.insert(obj["id"].toString(), obj);
-            }
+            joined.insert(pending);
+        }
+    }
 
-            for(auto &vid : m_accumulatedFeedResults) {
-                if (statsMap.contains(vid.id)) {
-                    QJsonObject stats = statsMap[vid.id]["statistics"].toObject();
-                    vid.viewCount = stats["viewCount"].toString().toULongLong();
-                    vid.likeCount = stats["likeCount"].toString().toULongLong();
-                    
-                    QJsonObject content = statsMap[vid.id]["contentDetails"].toObject();
-                    vid.duration = content["duration"].toString();
-                }
+    static Metrics::Counter &deduplicated = Metrics::counter("cache.video_stats.in_flight");
+    deduplicated.add(videoIds.size() - unrequested.size());
+
+    const int batchSize = VideoStatsCache::BATCH_SIZE;
+    auto remaining = std::make_shared<int>((unrequested.size() + batchSize - 1) / batchSize + joined.size());
+    auto countDown = [remaining, done]() {
+        if (--*remaining == 0) done();
+    };
+    for (int batchId : joined) m_statsWaiters[batchId].append(countDown);
+
+    for (int i = 0; i < unrequested.size(); i += batchSize) {
+        QStringList batch = unrequested.mid(i, batchSize);
+        int batchId = m_nextStatsBatch++;
+        m_videoStats.setPending(batch, batchId);
+
+        QUrl url = apiUrl("videos");
+        QUrlQuery q;
+        q.addQueryItem("part", "statistics,contentDetails");
+        q.addQueryItem("id", batch.join(","));
+        if (!m_apiKey.isEmpty()) {
+            q.addQueryItem("key", m_apiKey);
+        }
+        url.setQuery(q);
+
+        getAuthorized(url, [this, batch, batchId, countDown](QNetworkReply *reply) {
+            reply->deleteLater();
+            if (reply->error()) {
+                LOG_WARN("YouTubeService", "Stats fetch error: %s", reply->errorString());
+                m_videoStats.clearPending(batch);
+            } else {
+                TRACE_SCOPE("parse", "video statistics");
+                m_videoStats.insert(QJsonDocument::fromJson(reply->readAll()), batch, QDateTime::currentDateTimeUtc());
             }
+            QList<std::function<void()>> waiters = m_statsWaiters.take(batchId);
+            countDown();
+            for (const auto &waiter : waiters) waiter();
+        });
+    }
+}
+
+void YouTubeService::enrichSearchResults(QList<VideoResult> &results) {
+    QStringList missing = applyCachedStatistics(results);
+    if (missing.isEmpty()) return;
 
-            QDateTime now = QDateTime::currentDateTime();
-            
-            std::sort(m_accumulatedFeedResults.begin(), m_accumulatedFeedResults.end(), 
-                [now](const VideoResult &a, const VideoResult &b) {
-                    QDateTime da = QDateTime::fromString(a.publishedAt, Qt::ISODate);
-                    QDateTime db = QDateTime::fromString(b.publishedAt, Qt::ISODate);
-                    
-                    double hoursA = da.secsTo(now) / 3600.0;
-                    double hoursB = db.secsTo(now) / 3600.0;
-                    if (hoursA < 0) hoursA = 0;
-                    if (hoursB < 0) hoursB = 0;
-                    
-                    double scoreA = (double)a.viewCount / std::pow(hoursA + 2.0, 1.5);
-                    double scoreB = (double)b.viewCount / std::pow(hoursB + 2.0, 1.5);
-                    
-                    return scoreA > scoreB;
-                });
-                
-             printf("[YouTubeService] Smart sorted %d videos\n", m_accumulatedFeedResults.size());
-             fflush(stdout);
-             emit subscriptionFeedReady(m_accumulatedFeedResults);
+    fetchVideoStatistics(missing, [this, missing]() {
+        QList<VideoResult> updated;
+        for (const QString &id : missing) {
+            VideoResult vid;
+            vid.id = id;
+            updated.append(vid);
         }
-        reply->deleteLater();
+        m_videoStats.apply(updated, QDateTime::currentDateTimeUtc());
+        for (const auto &vid : updated) m_recommender.updateStatistics(vid);
+        emit videoStatisticsReady(updated);
     });
 }
 
@@ -283,14 +781,14 @@ void YouTubeService::muteChannel(const QString &channelId, const QString &channe
     if (!m_mutedChannelIds.contains(channelId)) {
         m_mutedChannelIds.insert(channelId);
         saveSettings();
-        printf("[YouTubeService] Muted channel: %s (%s)\n", channelName.toUtf8().constData(), channelId.toUtf8().constData());
+        LOG_INFO("YouTubeService", "Muted channel: %s (%s)", channelName, channelId);
     }
 }
 
 void YouTubeService::unmuteChannel(const QString &channelId) {
     if (m_mutedChannelIds.remove(channelId)) {
         saveSettings();
-        printf("[YouTubeService] Unmuted channel: %s\n", channelId.toUtf8().constData());
+        LOG_INFO("YouTubeService", "Unmuted channel: %s", channelId);
     }
 }
 
@@ -306,28 +804,93 @@ void YouTubeService::loadSettings() {
     QSettings settings("YouCpp", "YouCpp");
     QStringList list = settings.value("mutedChannels").toStringList();
     m_mutedChannelIds = QSet<QString>(list.begin(), list.end());
+
+    m_searchHistory = settings.value("search/history").toStringList();
+    for (int i = m_searchHistory.size() - 1; i >= 0; --i) {
+        m_suggestions.insert(m_searchHistory[i], 2.0 + ++m_searchSequence);
+    }
+
+    m_recommender.setSubscribedChannels(settings.value("recommendations/subscribedChannels").toStringList());
+    for (const QVariant &entry : settings.value("recommendations/watchHistory").toList()) {
+        QVariantMap watch = entry.toMap();
+        m_recommender.recordWatch({watch["videoId"].toString(), watch["channelId"].toString(),
+                                   watch["watchedAt"].toLongLong()});
+    }
 }
 
 void YouTubeService::saveSettings() {
     QSettings settings("YouCpp", "YouCpp");
     settings.setValue("mutedChannels", QStringList(m_mutedChannelIds.values()));
+    settings.setValue("search/history", m_searchHistory);
+
+    settings.setValue("recommendations/subscribedChannels", m_recommender.subscribedChannels());
+    QVariantList history;
+    for (const auto &watch : m_recommender.watchHistory()) {
+        history.append(QVariantMap{{"videoId", watch.videoId},
+                                   {"channelId", watch.channelId},
+                                   {"watchedAt", watch.watchedAt}});
+    }
+    settings.setValue("recommendations/watchHistory", history);
 }
 
 void YouTubeService::onSearchReply(QNetworkReply *reply) {
+    reply->deleteLater();
+    // Superseded by a newer query (or aborted): only the latest one renders
+    if (reply != m_searchReply) return;
+
+    m_searchReply = nullptr;
+
     if (reply->error()) {
-        emit errorOccurred("Network Error: " + reply->errorString());
-        reply->deleteLater();
+        // Let the same query be retried
+        m_searchKey.clear();
+        emit searchFailed("Network Error: " + reply->errorString());
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    QList<VideoResult> results = parseVideosFromJson(doc);
+    auto *cached = new CachedSearch;
+    {
+        TRACE_SCOPE("parse", "search response");
+        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+        cached->results = parseVideosFromJson(doc);
+        cached->nextPageToken = doc.object()["nextPageToken"].toString();
+    }
+    cached->fetchedAt = QDateTime::currentDateTimeUtc();
+    enrichSearchResults(cached->results);
+    m_recommender.addCandidates(cached->results);
+    m_searchCache.insert(m_searchKey, cached, 1);
+
+    QList<VideoResult> results = cached->results;
+    addTitleSuggestions(results);
     emit searchResultsReady(results);
-    reply->deleteLater();
+    // The page is on screen; fetch the next one while the user looks at it. Typeahead pages are
+    // usually superseded within seconds, so they only fetch more once scrolled to the end.
+    if (m_searchCommitted) prefetchNextSearchPage();
+}
+
+void YouTubeService::sortBySmartScore(QList<VideoResult> &videos, const QDateTime &now) {
+    Trace::Scope span("rank", "sortBySmartScore");
+    span.setArg("videos", videos.size());
+    std::sort(videos.begin(), videos.end(),
+        [now](const VideoResult &a, const VideoResult &b) {
+            QDateTime da = QDateTime::fromString(a.publishedAt, Qt::ISODate);
+            QDateTime db = QDateTime::fromString(b.publishedAt, Qt::ISODate);
+
+            double hoursA = da.secsTo(now) / 3600.0;
+            double hoursB = db.secsTo(now) / 3600.0;
+            if (hoursA < 0) hoursA = 0;
+            if (hoursB < 0) hoursB = 0;
+
+            double scoreA = (double)a.viewCount / std::pow(hoursA + 2.0, 1.5);
+            double scoreB = (double)b.viewCount / std::pow(hoursB + 2.0, 1.5);
+
+            return scoreA > scoreB;
+        });
 }
 
 QList<VideoResult> YouTubeService::parseVideosFromJson(const QJsonDocument &doc) {
     QJsonArray items = doc.object()["items"].toArray();
+    Trace::Scope span("parse", "parseVideosFromJson");
+    span.setArg("items", items.size());
     
     QList<VideoResult> results;
     for (const auto &item : items) {
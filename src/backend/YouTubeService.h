@@ -5,19 +5,19 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCache>
+#include <QDateTime>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+#include <functional>
+#include "Transcript.h"
+#include "SuggestionTrie.h"
+#include "VideoResult.h"
+#include "VideoStatsCache.h"
+#include "Recommender.h"
 
-struct VideoResult {
-    QString id;
-    QString title;
-    QString channel;
-    QString channelId;
-    QString thumbnailUrl;
-    QString publishedAt;
-    
-    unsigned long long viewCount = 0;
-    unsigned long long likeCount = 0;
-    QString duration;
-};
+class GoogleAuth;
 
 class YouTubeService : public QObject {
     Q_OBJECT
@@ -25,13 +25,40 @@ class YouTubeService : public QObject {
 public:
     explicit YouTubeService(QObject *parent = nullptr);
     
-    // Public search (uses API key)
-    void searchVideos(const QString &query);
+    // Public search (uses API key). A newer query aborts the one in flight; recent
+    // queries are answered from an LRU cache without spending quota. Only committed queries
+    // (Enter, not typeahead) prefetch their second page.
+    void searchVideos(const QString &query, bool committed = true);
+    void cancelSearch();
+    // Queries that differ only in case or spacing share a key (and a cache entry)
+    static QString searchKey(const QString &query);
+
+    // Paging for the current query: the next page is prefetched as soon as one is shown,
+    // so fetchMore usually appends without a round trip
+    bool hasMoreSearchResults() const;
+    void fetchMoreSearchResults();
+
+    // Typeahead: committed queries and seen titles, heaviest first
+    void recordSearch(const QString &query);
+    QStringList searchSuggestions(const QString &prefix, int limit = 8) const;
     
+    // Data API root, e.g. a local mock server; defaults to YOUTUBE_API_BASE_URL or googleapis.com
+    void setApiBaseUrl(const QString &baseUrl);
+
     // Authenticated endpoints (require access token)
     void setAccessToken(const QString &token);
+    void setAuth(GoogleAuth *auth);
     void fetchSubscriptionsFeed();
+
+    // Ranked locally from videos already fetched and the watch history; no API calls, so it
+    // works signed out and offline. recommendationsReady is emitted before this returns.
     void fetchRecommendations();
+    void recordWatch(const QString &videoId, const QString &channelId);
+    // Videos fetched in earlier sessions, e.g. from the local index
+    void addRecommendationCandidates(const QList<VideoResult> &videos);
+
+    // Captions via the public timed-text endpoint; YOUCPP_CAPTION_DIR=<dir> serves <id>.vtt/.xml fixtures instead
+    void fetchTranscript(const QString &videoId);
     
     // Channel Muting
     void muteChannel(const QString &channelId, const QString &channelName);
@@ -39,10 +66,26 @@ public:
     bool isChannelMuted(const QString &channelId) const;
     QStringList getMutedChannels() const;
 
+    // Response handling shared by the fetch paths; pure, so benchmarks can drive them directly
+    static QList<VideoResult> parseVideosFromJson(const QJsonDocument &doc);
+    // Views per (age in hours + 2)^1.5, highest first
+    static void sortBySmartScore(QList<VideoResult> &videos, const QDateTime &now);
+
 signals:
     void searchResultsReady(const QList<VideoResult> &results);
+    void searchResultsAppended(const QList<VideoResult> &results);
     void subscriptionFeedReady(const QList<VideoResult> &results);
+    // Paging through the subscriptions has ended, usually after the feed is ready; the count
+    // is partial when a later page failed
+    void subscriptionsLoaded(int count);
     void recommendationsReady(const QList<VideoResult> &results);
+    // Statistics that arrived after the search results they belong to; only id and the
+    // statistics fields are set
+    void videoStatisticsReady(const QList<VideoResult> &videos);
+    void transcriptReady(const QString &videoId, const Transcript &transcript);
+    void transcriptUnavailable(const QString &videoId, const QString &reason);
+    // Search and paging failures; everything else reports through errorOccurred
+    void searchFailed(const QString &message);
     void errorOccurred(const QString &message);
 
 private slots:
@@ -50,17 +93,93 @@ private slots:
 
 private:
     void parseVideoList(QNetworkReply *reply, void (YouTubeService::*signal)(const QList<VideoResult> &));
-    QList<VideoResult> parseVideosFromJson(const QJsonDocument &doc);
+    QUrl apiUrl(const QString &endpoint) const;
+    // Every GET goes through here: tracing, per-host metrics and quota accounting
+    QNetworkReply *sendGet(const QNetworkRequest &request, const char *traceName);
+
+    // GET with the bearer token; a 401 parks the request until GoogleAuth refreshes, then replays it
+    void getAuthorized(const QUrl &url, std::function<void(QNetworkReply *)> onFinished, bool isRetry = false);
+    void replayPendingRequests(const QString &accessToken);
+    void failPendingRequests();
+    void fetchTranscriptTrack(const QString &videoId, QNetworkReply *listReply);
+    void parseTranscriptAsync(const QString &videoId, std::function<Transcript()> work);
     
     QNetworkAccessManager *m_manager;
     QString m_apiKey;
+    QString m_apiBaseUrl;
     QString m_accessToken;
+    GoogleAuth *m_auth = nullptr;
+
+    struct PendingRequest {
+        QUrl url;
+        std::function<void(QNetworkReply *)> onFinished;
+        QNetworkReply *unauthorizedReply = nullptr;
+    };
+    QList<PendingRequest> m_pendingAuthRequests;
     
+    // Feed: uploads of the first FEED_CHANNEL_LIMIT unmuted subscriptions, fetched as soon as that
+    // many are known; the remaining subscription pages are paged in the background for the
+    // recommender. Replies from a superseded fetch carry an old generation and are dropped.
+    void fetchSubscriptionPage(const QString &pageToken, int page);
+    void fetchFeedChannels();
+    void fetchFeedPlaylist(const QString &playlistId, int generation);
+    int m_feedGeneration = 0;
+    QStringList m_feedChannelIds;
+    bool m_feedChannelsRequested = false;
     int m_pendingFeedRequests = 0;
     QList<VideoResult> m_accumulatedFeedResults;
 
-    void fetchVideoStatistics(QList<QString> videoIds);
+    // Statistics are shared by search and feed: cached ones are applied in place, misses are
+    // fetched in batches of VideoStatsCache::BATCH_SIZE and done runs once every batch is back
+    QStringList applyCachedStatistics(QList<VideoResult> &videos);
+    void fetchVideoStatistics(const QStringList &videoIds, std::function<void()> done);
+    void enrichSearchResults(QList<VideoResult> &results);
+    VideoStatsCache m_videoStats;
+    // Callers that found their ids in a batch already in flight, by batch
+    QHash<int, QList<std::function<void()>>> m_statsWaiters;
+    int m_nextStatsBatch = 0;
+    Recommender m_recommender;
     void loadSettings();
     void saveSettings();
     QSet<QString> m_mutedChannelIds;
+
+    // Pages shown so far plus the prefetched one not yet shown
+    struct CachedSearch {
+        QList<VideoResult> results;
+        QString nextPageToken;
+        QList<VideoResult> prefetchedPage;
+        QString prefetchedNextToken;
+        bool hasPrefetched = false;
+        QDateTime fetchedAt;
+    };
+    QUrl searchUrl(const QString &query, const QString &pageToken) const;
+    void addTitleSuggestions(const QList<VideoResult> &results);
+    void prefetchNextSearchPage();
+    void promotePrefetchedPage(CachedSearch *cached);
+    void onSearchPageReply(QNetworkReply *reply, const QString &key);
+
+    QPointer<QNetworkReply> m_searchReply;
+    QPointer<QNetworkReply> m_pageReply;
+    // Query currently shown (or on its way); pages are fetched for it
+    QString m_searchKey;
+    QString m_searchQuery;
+    bool m_appendNextPage = false;
+    bool m_searchCommitted = false;
+    QCache<QString, CachedSearch> m_searchCache;
+    SuggestionTrie m_suggestions;
+    QStringList m_searchHistory;
+    // Weight of the latest history entry in m_suggestions, above 2 so titles never outrank it
+    int m_searchSequence = 0;
+    // Titles in m_suggestions, oldest first, and their trie keys
+    QQueue<QString> m_titleSuggestions;
+    QSet<QString> m_titleSuggestionKeys;
+
+    static const int SEARCH_PAGE_SIZE;
+    static const int SEARCH_CACHE_ENTRIES;
+    static const int SEARCH_CACHE_TTL_SECS;
+    static const int SEARCH_HISTORY_LIMIT;
+    static const int TITLE_SUGGESTION_LIMIT;
+    static const int FEED_CHANNEL_LIMIT;
+    static const int MAX_SUBSCRIPTION_PAGES;
+    static const int RECOMMENDATION_LIMIT;
 };
@@ -0,0 +1,275 @@
+// Headless driver for the backend: runs one search/feed/transcript request against the live
+// API and prints a JSON report (timings + results) on stdout, for scripting and benchmarking.
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTimer>
+#include "../backend/Env.h"
+#include "../backend/GoogleAuth.h"
+#include "../backend/Log.h"
+#include "../backend/ProcessMemory.h"
+#include "../backend/Trace.h"
+#include "../backend/Transcript.h"
+#include "../backend/YouTubeService.h"
+#include <cstdio>
+
+namespace {
+
+const int REQUEST_TIMEOUT_MS = 60000;
+
+void printUsage() {
+    fprintf(stderr,
+            "Usage: youcpp-cli <command> [args] [options]\n"
+            "\n"
+            "Commands:\n"
+            "  search <query>               YouTube search (API key from YOUTUBE_API_KEY)\n"
+            "  feed                         Subscription feed (GUI's stored sign-in, or YOUCPP_ACCESS_TOKEN)\n"
+            "  transcript <videoId> [query] Fetch and index captions, optionally search them\n"
+            "\n"
+            "Options:\n"
+            "  --pages N    search: follow nextPageToken for N pages (default 1)\n"
+            "  --summary    omit result lists, print timings and counts only\n"
+            "  --pretty     indented JSON\n");
+}
+
+QJsonObject videoToJson(const VideoResult &vid) {
+    QJsonObject obj;
+    obj["id"] = vid.id;
+    obj["title"] = vid.title;
+    obj["channel"] = vid.channel;
+    obj["channelId"] = vid.channelId;
+    obj["publishedAt"] = vid.publishedAt;
+    obj["viewCount"] = QString::number(vid.viewCount);
+    obj["likeCount"] = QString::number(vid.likeCount);
+    obj["duration"] = vid.duration;
+    return obj;
+}
+
+QJsonArray videosToJson(const QList<VideoResult> &results) {
+    QJsonArray array;
+    for (const auto &vid : results) array.append(videoToJson(vid));
+    return array;
+}
+
+class CliRun : public QObject {
+public:
+    CliRun(const QString &command, bool summary, bool pretty)
+        : m_summary(summary)
+        , m_pretty(pretty)
+    {
+        m_report["command"] = command;
+        m_total.start();
+
+        QTimer::singleShot(REQUEST_TIMEOUT_MS, this, [this]() { fail("Timed out"); });
+    }
+
+    void search(YouTubeService *service, const QString &query, int pages) {
+        m_report["query"] = query;
+        m_pages = pages;
+
+        connect(service, &YouTubeService::searchFailed, this, &CliRun::fail);
+        connect(service, &YouTubeService::searchResultsReady, this, [this, service](const QList<VideoResult> &results) {
+            m_results = results;
+            searchPageReady(service);
+        });
+        connect(service, &YouTubeService::searchResultsAppended, this, [this, service](const QList<VideoResult> &results) {
+            m_results += results;
+            searchPageReady(service);
+        });
+
+        m_phase.start();
+        service->searchVideos(query);
+    }
+
+    void feed(GoogleAuth *auth, YouTubeService *service) {
+        connect(service, &YouTubeService::errorOccurred, this, &CliRun::fail);
+        connect(auth, &GoogleAuth::tokenRefreshFailed, this, &CliRun::fail);
+        // The feed starts before all subscriptions are paged; finishing only once both are done
+        // keeps the run's request count independent of timing
+        connect(service, &YouTubeService::subscriptionFeedReady, this, [this](const QList<VideoResult> &results) {
+            m_timings["feed"] = m_phase.elapsed();
+            m_report["count"] = results.size();
+            if (!m_summary) m_report["results"] = videosToJson(results);
+            m_feedReady = true;
+            if (m_subscriptionsLoaded) succeed();
+        });
+        connect(service, &YouTubeService::subscriptionsLoaded, this, [this](int count) {
+            m_timings["subscriptions"] = m_phase.elapsed();
+            m_report["subscriptions"] = count;
+            m_subscriptionsLoaded = true;
+            if (m_feedReady) succeed();
+        });
+
+        auto startFeed = [this, auth, service]() {
+            service->setAccessToken(auth->accessToken());
+            m_phase.start();
+            service->fetchSubscriptionsFeed();
+        };
+
+        // Fixed token for runs against a mock API; skips the stored sign-in
+        QString token = qEnvironmentVariable("YOUCPP_ACCESS_TOKEN");
+        if (!token.isEmpty()) {
+            service->setAccessToken(token);
+            m_phase.start();
+            service->fetchSubscriptionsFeed();
+        } else if (auth->isRefreshing()) {
+            m_phase.start();
+            connect(auth, &GoogleAuth::tokenRefreshed, this, [this, startFeed]() {
+                m_timings["token_refresh"] = m_phase.elapsed();
+                startFeed();
+            }, Qt::SingleShotConnection);
+        } else if (auth->isAuthenticated()) {
+            startFeed();
+        } else {
+            fail("Not signed in; sign in once from the GUI");
+        }
+    }
+
+    void transcript(YouTubeService *service, const QString &videoId, const QString &query) {
+        m_report["videoId"] = videoId;
+        connect(service, &YouTubeService::transcriptUnavailable, this, [this](const QString &, const QString &reason) {
+            fail(reason);
+        });
+        connect(service, &YouTubeService::transcriptReady, this,
+                [this, query](const QString &, const Transcript &transcript) {
+            m_timings["fetch_and_parse"] = m_phase.elapsed();
+            m_report["segments"] = transcript.size();
+            m_report["language"] = transcript.language();
+
+            if (!query.isEmpty()) {
+                QElapsedTimer searchTimer;
+                searchTimer.start();
+                QVector<int> hits = transcript.search(query);
+                m_timings["search_us"] = searchTimer.nsecsElapsed() / 1000;
+                m_report["query"] = query;
+                m_report["count"] = hits.size();
+
+                if (!m_summary) {
+                    QJsonArray array;
+                    for (int index : hits) {
+                        QJsonObject hit;
+                        hit["startMs"] = transcript.startMs(index);
+                        hit["text"] = transcript.text(index);
+                        array.append(hit);
+                    }
+                    m_report["results"] = array;
+                }
+            }
+            succeed();
+        });
+
+        m_phase.start();
+        service->fetchTranscript(videoId);
+    }
+
+    void fail(const QString &error) {
+        m_report["ok"] = false;
+        m_report["error"] = error;
+        print(1);
+    }
+
+private:
+    void searchPageReady(YouTubeService *service) {
+        m_timings[QString("page_%1").arg(m_page)] = m_phase.elapsed();
+        if (m_page >= m_pages || !service->hasMoreSearchResults()) {
+            m_report["count"] = m_results.size();
+            if (!m_summary) m_report["results"] = videosToJson(m_results);
+            succeed();
+            return;
+        }
+        ++m_page;
+        m_phase.start();
+        service->fetchMoreSearchResults();
+    }
+
+    void succeed() {
+        m_report["ok"] = true;
+        print(0);
+    }
+
+    void print(int exitCode) {
+        if (m_done) return;
+        m_done = true;
+
+        m_timings["total"] = m_total.elapsed();
+        m_report["timings_ms"] = m_timings;
+        m_report["peak_rss_bytes"] = ProcessMemory::peakResidentBytes();
+        QByteArray json = QJsonDocument(m_report).toJson(m_pretty ? QJsonDocument::Indented : QJsonDocument::Compact);
+        fwrite(json.constData(), 1, json.size(), stdout);
+        if (!m_pretty) fputc('\n', stdout);
+        fflush(stdout);
+        QCoreApplication::exit(exitCode);
+    }
+
+    QJsonObject m_report;
+    QJsonObject m_timings;
+    QElapsedTimer m_total;
+    QElapsedTimer m_phase;
+    // search: pages collected so far, and how many were asked for
+    QList<VideoResult> m_results;
+    int m_page = 1;
+    int m_pages = 1;
+    // feed: the feed and the full subscription list both have to arrive
+    bool m_feedReady = false;
+    bool m_subscriptionsLoaded = false;
+    bool m_summary;
+    bool m_pretty;
+    bool m_done = false;
+};
+
+}
+
+int main(int argc, char *argv[]) {
+    // stdout carries only the report
+    Log::setOutput(stderr);
+    Trace::init();
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("YouCpp");
+    app.setApplicationName("YouCpp");
+
+    QStringList args = app.arguments().mid(1);
+    bool summary = args.removeAll("--summary") > 0;
+    bool pretty = args.removeAll("--pretty") > 0;
+    int pages = 1;
+    int pagesIndex = args.indexOf("--pages");
+    if (pagesIndex >= 0 && pagesIndex + 1 < args.size()) {
+        pages = std::max(1, args[pagesIndex + 1].toInt());
+        args.remove(pagesIndex, 2);
+    }
+
+    if (args.isEmpty()) {
+        printUsage();
+        return 2;
+    }
+    QString command = args.takeFirst();
+
+    loadEnv();
+    Log::configure();
+
+    GoogleAuth auth;
+    YouTubeService service;
+    service.setAuth(&auth);
+    auth.setCredentials(qEnvironmentVariable("GOOGLE_CLIENT_ID"),
+                        qEnvironmentVariable("GOOGLE_CLIENT_SECRET"));
+
+    CliRun run(command, summary, pretty);
+    if (command == "search" && !args.isEmpty()) {
+        run.search(&service, args.join(' '), pages);
+    } else if (command == "feed") {
+        run.feed(&auth, &service);
+    } else if (command == "transcript" && !args.isEmpty()) {
+        QString videoId = args.takeFirst();
+        run.transcript(&service, videoId, args.join(' '));
+    } else {
+        printUsage();
+        return 2;
+    }
+
+    int result = app.exec();
+    Trace::shutdown();
+    Log::flush();
+    return result;
+}
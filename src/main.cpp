@@ -1,49 +1,50 @@
 #include <QApplication>
-#include <QFile>
-#include <QTextStream>
-#include <QDir>
 #include "ui/MainWindow.h"
+#include "backend/Env.h"
+#include "backend/Log.h"
+#include "backend/Trace.h"
+#include "ui/StartupSequencer.h"
+#include "ui/EventLoopMonitor.h"
+#include "ui/PlayerMemoryBudget.h"
+#include <QFontDatabase>
+#include <QElapsedTimer>
+#include <cstring>
 
-void loadEnv() {
-    QString envPath = ".env";
-    if (!QFile::exists(envPath)) {
-        envPath = "../.env"; 
-    }
-
-    QFile file(envPath);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        while (!in.atEnd()) {
-            QString line = in.readLine().trimmed();
-            if (line.isEmpty() || line.startsWith('#')) continue;
+int main(int argc, char *argv[]) {
+    QElapsedTimer processClock;
+    processClock.start();
+    Trace::init();
 
-            QStringList parts = line.split('=');
-            if (parts.size() >= 2) {
-                QString key = parts[0].trimmed();
-                QString value = parts[1].trimmed().remove('"').remove('\'');
-                qputenv(key.toUtf8(), value.toUtf8());
-            }
-        }
-        file.close();
+    bool traceStartup = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace-startup") == 0) {
+            traceStartup = true;
+        }
     }
-}
 
-#include <QApplication>
-#include "ui/MainWindow.h"
-#include <QFontDatabase>
-#include <cstdio>
-
-int main(int argc, char *argv[]) {
-    printf("[YouCpp] Starting application...\n");
-    fflush(stdout);
+    LOG_INFO("YouCpp", "Starting application...");
     
     qputenv("QTWEBENGINE_CHROMIUM_FLAGS", 
             "--no-sandbox "
             "--autoplay-policy=no-user-gesture-required "
             "--allow-running-insecure-content "
+            + PlayerMemoryBudget::processModelFlags() +
             "--user-agent=\"Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\"");
 
-    QApplication app(argc, argv);
+    // WebEngine is initialized lazily on the first player view, which requires shared GL contexts up front
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
+    // Times GUI-thread event dispatches; stalls show up in the Diagnostics tab (Ctrl+Shift+D)
+    MonitoredApplication app(argc, argv);
+    app.setOrganizationName("YouCpp");
+    app.setApplicationName("YouCpp");
+
+    StartupSequencer startup(processClock, traceStartup);
+    startup.mark("QApplication created");
+
+    // Credentials must be in the environment before the sequencer starts the token refresh
+    loadEnv();
+    Log::configure();
 
     app.setStyle("Fusion");
 
@@ -279,11 +280,12 @@ int main(int argc, char *argv[]) {
         }
     )";
     app.setStyleSheet(qss);
-    
-    loadEnv(); 
+    startup.mark("stylesheet applied");
 
-    MainWindow window;
-    window.show();
+    MainWindow *window = startup.start();
 
-    return app.exec();
+    int result = app.exec();
+    delete window;
+    Trace::shutdown();
+    return result;
 }
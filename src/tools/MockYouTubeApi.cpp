@@ -0,0 +1,271 @@
+#include "MockYouTubeApi.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimeZone>
+#include <QTimer>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+const int MAX_PAGE_SIZE = 50;
+const int SEARCH_TOTAL_RESULTS = 500;
+
+// Fixed reference so responses are identical across runs
+QDateTime publishEpoch() {
+    return QDateTime(QDate(2025, 1, 1), QTime(0, 0), QTimeZone::utc());
+}
+}
+
+MockYouTubeApi::MockYouTubeApi(const Config &config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_random(config.seed)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &MockYouTubeApi::onNewConnection);
+}
+
+bool MockYouTubeApi::listen(quint16 port) {
+    return m_server.listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockYouTubeApi::port() const {
+    return m_server.serverPort();
+}
+
+QString MockYouTubeApi::baseUrl() const {
+    return QString("http://127.0.0.1:%1/youtube/v3").arg(port());
+}
+
+void MockYouTubeApi::resetCounters() {
+    m_requestCount = 0;
+    m_failedCount = 0;
+    m_byEndpoint.clear();
+}
+
+void MockYouTubeApi::onNewConnection() {
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockYouTubeApi::onReadyRead(QTcpSocket *socket) {
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    // Keep-alive: one connection carries many requests; all of ours are body-less GETs
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        QByteArray head = buffer.left(headerEnd);
+        buffer.remove(0, headerEnd + 4);
+
+        QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+        if (requestLine.size() < 2 || requestLine[0] != "GET") {
+            writeResponse(socket, 405, QJsonDocument(errorBody(405, "methodNotAllowed", "Only GET is served")).toJson());
+            continue;
+        }
+        handleRequest(socket, requestLine[1]);
+    }
+}
+
+void MockYouTubeApi::handleRequest(QTcpSocket *socket, const QByteArray &target) {
+    QUrl url("http://localhost" + QString::fromLatin1(target));
+    QString endpoint = url.path().section('/', -1);
+    QUrlQuery query(url);
+
+    ++m_requestCount;
+    ++m_byEndpoint[endpoint];
+
+    int status = 200;
+    QJsonObject body;
+    if (m_config.errorRate > 0 && m_random.generateDouble() < m_config.errorRate) {
+        status = 500;
+        body = errorBody(500, "backendError", "Injected failure");
+    } else if (endpoint == "subscriptions") {
+        body = subscriptions(query);
+    } else if (endpoint == "channels") {
+        body = channels(query);
+    } else if (endpoint == "playlistItems") {
+        body = playlistItems(query);
+    } else if (endpoint == "videos") {
+        body = videos(query);
+    } else if (endpoint == "search") {
+        body = search(query);
+    } else {
+        status = 404;
+        body = errorBody(404, "notFound", "Unknown endpoint " + endpoint);
+    }
+    if (status != 200) ++m_failedCount;
+
+    QByteArray payload = QJsonDocument(body).toJson(QJsonDocument::Compact);
+    if (m_config.latencyMs <= 0) {
+        writeResponse(socket, status, payload);
+        return;
+    }
+    QPointer<QTcpSocket> guard(socket);
+    QTimer::singleShot(m_config.latencyMs, this, [this, guard, status, payload]() {
+        if (guard) writeResponse(guard, status, payload);
+    });
+}
+
+void MockYouTubeApi::writeResponse(QTcpSocket *socket, int status, const QByteArray &body) {
+    const char *reason = status == 200 ? "OK" : (status == 404 ? "Not Found" : "Error");
+    QByteArray head = QString("HTTP/1.1 %1 %2\r\n"
+                              "Content-Type: application/json; charset=UTF-8\r\n"
+                              "Content-Length: %3\r\n"
+                              "Connection: keep-alive\r\n\r\n")
+                          .arg(status).arg(reason).arg(body.size()).toLatin1();
+    socket->write(head);
+    socket->write(body);
+}
+
+int MockYouTubeApi::pageSize(const QUrlQuery &query) const {
+    int requested = query.hasQueryItem("maxResults") ? query.queryItemValue("maxResults").toInt() : 5;
+    return std::clamp(std::min(requested, m_config.pageSize), 1, MAX_PAGE_SIZE);
+}
+
+QJsonObject MockYouTubeApi::subscriptions(const QUrlQuery &query) const {
+    int offset = query.queryItemValue("pageToken").mid(1).toInt();
+    int end = std::min(offset + pageSize(query), m_config.channels);
+
+    QJsonArray items;
+    for (int c = offset; c < end; ++c) {
+        QJsonObject resource;
+        resource["kind"] = "youtube#channel";
+        resource["channelId"] = channelId(c);
+        QJsonObject snippet;
+        snippet["title"] = QString("Mock Channel %1").arg(c);
+        snippet["resourceId"] = resource;
+        items.append(QJsonObject{{"kind", "youtube#subscription"}, {"snippet", snippet}});
+    }
+
+    QJsonObject root;
+    root["kind"] = "youtube#subscriptionListResponse";
+    root["items"] = items;
+    root["pageInfo"] = QJsonObject{{"totalResults", m_config.channels}, {"resultsPerPage", pageSize(query)}};
+    if (end < m_config.channels) {
+        root["nextPageToken"] = QString("p%1").arg(end);
+    }
+    return root;
+}
+
+QJsonObject MockYouTubeApi::channels(const QUrlQuery &query) const {
+    QJsonArray items;
+    const QStringList ids = query.queryItemValue("id").split(',', Qt::SkipEmptyParts);
+    for (const QString &id : ids.mid(0, MAX_PAGE_SIZE)) {
+        if (!id.startsWith("UCmock")) continue;
+        QJsonObject related{{"uploads", "UU" + id.mid(2)}};
+        items.append(QJsonObject{{"kind", "youtube#channel"},
+                                 {"id", id},
+                                 {"contentDetails", QJsonObject{{"relatedPlaylists", related}}}});
+    }
+    return QJsonObject{{"kind", "youtube#channelListResponse"}, {"items", items}};
+}
+
+QJsonObject MockYouTubeApi::playlistItems(const QUrlQuery &query) const {
+    QString playlistId = query.queryItemValue("playlistId");
+    int channel = playlistId.mid(6).toInt();
+
+    QJsonArray items;
+    int count = playlistId.startsWith("UUmock") ? std::min(pageSize(query), m_config.videosPerChannel) : 0;
+    for (int v = 0; v < count; ++v) {
+        QJsonObject snippet = videoSnippet(channel, v);
+        snippet["resourceId"] = QJsonObject{{"kind", "youtube#video"}, {"videoId", videoId(channel, v)}};
+        items.append(QJsonObject{{"kind", "youtube#playlistItem"}, {"snippet", snippet}});
+    }
+    return QJsonObject{{"kind", "youtube#playlistItemListResponse"}, {"items", items}};
+}
+
+QJsonObject MockYouTubeApi::videos(const QUrlQuery &query) const {
+    QJsonArray items;
+    const QStringList ids = query.queryItemValue("id").split(',', Qt::SkipEmptyParts);
+    for (const QString &id : ids.mid(0, MAX_PAGE_SIZE)) {
+        int channel, index;
+        if (!parseVideoId(id, &channel, &index)) continue;
+
+        quint32 hash = quint32(channel) * 2654435761u ^ quint32(index + 1) * 40503u;
+        QJsonObject statistics{{"viewCount", QString::number(hash % 2000000)},
+                               {"likeCount", QString::number(hash % 50000)}};
+        QString duration = QString("PT%1M%2S").arg(2 + hash % 40).arg(hash % 60);
+        items.append(QJsonObject{{"kind", "youtube#video"},
+                                 {"id", id},
+                                 {"snippet", videoSnippet(channel, index)},
+                                 {"statistics", statistics},
+                                 {"contentDetails", QJsonObject{{"duration", duration}}}});
+    }
+    return QJsonObject{{"kind", "youtube#videoListResponse"}, {"items", items}};
+}
+
+QJsonObject MockYouTubeApi::search(const QUrlQuery &query) const {
+    QString q = query.queryItemValue("q", QUrl::FullyDecoded);
+    int offset = query.queryItemValue("pageToken").mid(1).toInt();
+    int end = std::min(offset + pageSize(query), SEARCH_TOTAL_RESULTS);
+
+    // Spread results across channels so search, feed and stats share ids
+    int channels = std::max(1, m_config.channels);
+    QJsonArray items;
+    for (int r = offset; r < end; ++r) {
+        int channel = r % channels;
+        int index = (r / channels) % std::max(1, m_config.videosPerChannel);
+        QJsonObject snippet = videoSnippet(channel, index);
+        snippet["title"] = QString("%1 - result %2").arg(q).arg(r + 1);
+        items.append(QJsonObject{{"kind", "youtube#searchResult"},
+                                 {"id", QJsonObject{{"kind", "youtube#video"}, {"videoId", videoId(channel, index)}}},
+                                 {"snippet", snippet}});
+    }
+
+    QJsonObject root{{"kind", "youtube#searchListResponse"}, {"items", items}};
+    root["pageInfo"] = QJsonObject{{"totalResults", SEARCH_TOTAL_RESULTS}, {"resultsPerPage", pageSize(query)}};
+    if (end < SEARCH_TOTAL_RESULTS) {
+        root["nextPageToken"] = QString("p%1").arg(end);
+    }
+    return root;
+}
+
+QJsonObject MockYouTubeApi::videoSnippet(int channel, int index) const {
+    QString id = videoId(channel, index);
+    // Newest uploads first within a channel, channels staggered across ~90 days
+    qint64 hoursAgo = (qint64(channel) * 7 + qint64(index) * 29) % (24 * 90);
+
+    QJsonObject medium{{"url", QString("https://i.ytimg.com/vi/%1/mqdefault.jpg").arg(id)},
+                       {"width", 320}, {"height", 180}};
+    QJsonObject snippet;
+    snippet["publishedAt"] = publishEpoch().addSecs(-hoursAgo * 3600).toString(Qt::ISODate);
+    snippet["channelId"] = channelId(channel);
+    snippet["channelTitle"] = QString("Mock Channel %1").arg(channel);
+    snippet["title"] = QString("Mock video %1 from channel %2").arg(index + 1).arg(channel);
+    snippet["description"] = "Synthetic video served by youcpp-mock-api.";
+    snippet["thumbnails"] = QJsonObject{{"medium", medium}};
+    return snippet;
+}
+
+QString MockYouTubeApi::channelId(int channel) {
+    return QString("UCmock%1").arg(channel, 6, 10, QChar('0'));
+}
+
+// 11 characters like real ids: m<channel:6>v<index:3>
+QString MockYouTubeApi::videoId(int channel, int index) {
+    return QString("m%1v%2").arg(channel, 6, 10, QChar('0')).arg(index, 3, 10, QChar('0'));
+}
+
+bool MockYouTubeApi::parseVideoId(const QString &id, int *channel, int *index) {
+    if (id.size() != 11 || id[0] != 'm' || id[7] != 'v') return false;
+    bool okChannel, okIndex;
+    *channel = id.mid(1, 6).toInt(&okChannel);
+    *index = id.mid(8, 3).toInt(&okIndex);
+    return okChannel && okIndex;
+}
+
+QJsonObject MockYouTubeApi::errorBody(int code, const QString &reason, const QString &message) {
+    QJsonObject error;
+    error["code"] = code;
+    error["message"] = message;
+    error["errors"] = QJsonArray{QJsonObject{{"reason", reason}, {"message", message}}};
+    return QJsonObject{{"error", error}};
+}
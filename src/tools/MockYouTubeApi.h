@@ -0,0 +1,68 @@
+#pragma once
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTcpServer>
+#include <QUrlQuery>
+
+class QTcpSocket;
+
+// Minimal HTTP/1.1 stand-in for the YouTube Data API v3 endpoints the app uses (subscriptions,
+// channels, playlistItems, videos, search). Data is synthetic and deterministic for a given config;
+// point YouTubeService at baseUrl() through YOUTUBE_API_BASE_URL.
+class MockYouTubeApi : public QObject {
+    Q_OBJECT
+
+public:
+    struct Config {
+        int channels = 50;
+        // Upper bound on maxResults, like the real API's 50
+        int pageSize = 50;
+        int videosPerChannel = 5;
+        int latencyMs = 0;
+        // Fraction of requests answered with a 500 backendError
+        double errorRate = 0.0;
+        quint32 seed = 1;
+    };
+
+    explicit MockYouTubeApi(const Config &config, QObject *parent = nullptr);
+
+    // Port 0 picks a free one
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+    QString baseUrl() const;
+
+    int requestCount() const { return m_requestCount; }
+    int failedCount() const { return m_failedCount; }
+    QHash<QString, int> requestsByEndpoint() const { return m_byEndpoint; }
+    void resetCounters();
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QByteArray &target);
+    void writeResponse(QTcpSocket *socket, int status, const QByteArray &body);
+
+    QJsonObject subscriptions(const QUrlQuery &query) const;
+    QJsonObject channels(const QUrlQuery &query) const;
+    QJsonObject playlistItems(const QUrlQuery &query) const;
+    QJsonObject videos(const QUrlQuery &query) const;
+    QJsonObject search(const QUrlQuery &query) const;
+
+    int pageSize(const QUrlQuery &query) const;
+    QJsonObject videoSnippet(int channel, int index) const;
+    static QString channelId(int channel);
+    static QString videoId(int channel, int index);
+    static bool parseVideoId(const QString &id, int *channel, int *index);
+    static QJsonObject errorBody(int code, const QString &reason, const QString &message);
+
+    Config m_config;
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QRandomGenerator m_random;
+    int m_requestCount = 0;
+    int m_failedCount = 0;
+    QHash<QString, int> m_byEndpoint;
+};
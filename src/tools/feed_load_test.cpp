@@ -0,0 +1,180 @@
+// End-to-end feed load test: runs `youcpp-cli feed` against an in-process MockYouTubeApi for
+// several subscription counts and reports feed latency, API request count and the CLI's peak RSS.
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTimer>
+#include "MockYouTubeApi.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const int RUN_TIMEOUT_MS = 120000;
+
+struct RunResult {
+    bool ok = false;
+    QString error;
+    qint64 feedMs = 0;
+    qint64 totalMs = 0;
+    qint64 peakRssBytes = 0;
+    int videos = 0;
+    int requests = 0;
+    int failedRequests = 0;
+};
+
+RunResult runFeed(const QString &cliPath, const MockYouTubeApi::Config &config) {
+    RunResult result;
+
+    MockYouTubeApi api(config);
+    if (!api.listen()) {
+        result.error = "mock server could not listen";
+        return result;
+    }
+
+    // The CLI saves thousands of mock subscription ids to QSettings and writes caches; give it a
+    // throwaway home so none of that lands in the user's real config
+    QTemporaryDir home;
+    if (!home.isValid()) {
+        result.error = "could not create a temporary home";
+        return result;
+    }
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("HOME", home.path());
+    env.insert("XDG_CONFIG_HOME", home.filePath("config"));
+    env.insert("XDG_CACHE_HOME", home.filePath("cache"));
+    env.insert("XDG_DATA_HOME", home.filePath("data"));
+    env.insert("YOUTUBE_API_BASE_URL", api.baseUrl());
+    env.insert("YOUTUBE_API_KEY", "mock-key");
+    env.insert("YOUCPP_ACCESS_TOKEN", "mock-token");
+
+    QProcess cli;
+    cli.setProcessEnvironment(env);
+    // Keeps the CLI from picking up a developer .env pointing at the real API
+    cli.setWorkingDirectory(QDir::tempPath());
+    cli.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+    // The mock server lives on this thread, so wait in an event loop rather than waitForFinished()
+    QEventLoop loop;
+    QObject::connect(&cli, &QProcess::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&cli, &QProcess::errorOccurred, &loop, &QEventLoop::quit);
+    QTimer::singleShot(RUN_TIMEOUT_MS, &loop, &QEventLoop::quit);
+
+    cli.start(cliPath, {"feed", "--summary"});
+    loop.exec();
+
+    // The CLI exits only after the last subscription page, so this is every request of the run
+    result.requests = api.requestCount();
+    result.failedRequests = api.failedCount();
+
+    if (cli.state() != QProcess::NotRunning) {
+        cli.kill();
+        cli.waitForFinished();
+        result.error = "timed out";
+        return result;
+    }
+    if (cli.error() == QProcess::FailedToStart) {
+        result.error = "could not start " + cliPath;
+        return result;
+    }
+
+    QJsonObject report = QJsonDocument::fromJson(cli.readAllStandardOutput()).object();
+    QJsonObject timings = report["timings_ms"].toObject();
+    result.ok = report["ok"].toBool();
+    result.error = report["error"].toString();
+    result.feedMs = timings["feed"].toInteger();
+    result.totalMs = timings["total"].toInteger();
+    result.peakRssBytes = report["peak_rss_bytes"].toInteger();
+    result.videos = report["count"].toInt();
+    return result;
+}
+
+template <typename T>
+T median(QList<T> values) {
+    if (values.isEmpty()) return T();
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("feed_load_test");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Feed latency, request count and peak RSS against the mock API");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"cli", "Path to youcpp-cli.", "path", QDir(app.applicationDirPath()).filePath("youcpp-cli")},
+        {"sizes", "Comma-separated subscription counts.", "list", "50,500,5000"},
+        {"runs", "Runs per size; the median is reported.", "n", "3"},
+        {"page-size", "Mock page size.", "n", "50"},
+        {"latency", "Mock per-response latency, in ms.", "ms", "20"},
+        {"error-rate", "Mock error injection rate.", "rate", "0"},
+        {"json", "Print one JSON object per size instead of a table."},
+    });
+    parser.process(app);
+
+    QString cliPath = parser.value("cli");
+    int runs = std::max(1, parser.value("runs").toInt());
+    bool json = parser.isSet("json");
+
+    MockYouTubeApi::Config config;
+    config.pageSize = parser.value("page-size").toInt();
+    config.latencyMs = parser.value("latency").toInt();
+    config.errorRate = parser.value("error-rate").toDouble();
+
+    if (!json) {
+        printf("%-14s %10s %10s %9s %9s %12s %7s\n",
+               "subscriptions", "feed_ms", "total_ms", "requests", "failed", "peak_rss_mb", "videos");
+    }
+
+    int exitCode = 0;
+    for (const QString &size : parser.value("sizes").split(',', Qt::SkipEmptyParts)) {
+        config.channels = size.toInt();
+
+        QList<qint64> feedMs, totalMs, peakRss;
+        RunResult last;
+        for (int run = 0; run < runs; ++run) {
+            config.seed = run + 1;
+            last = runFeed(cliPath, config);
+            if (!last.ok) break;
+            feedMs.append(last.feedMs);
+            totalMs.append(last.totalMs);
+            peakRss.append(last.peakRssBytes);
+        }
+
+        if (!last.ok) {
+            fprintf(stderr, "%d subscriptions: %s\n", config.channels, last.error.toUtf8().constData());
+            exitCode = 1;
+            continue;
+        }
+
+        if (json) {
+            QJsonObject row;
+            row["subscriptions"] = config.channels;
+            row["runs"] = runs;
+            row["feed_ms"] = median(feedMs);
+            row["total_ms"] = median(totalMs);
+            row["requests"] = last.requests;
+            row["failed_requests"] = last.failedRequests;
+            row["peak_rss_bytes"] = median(peakRss);
+            row["videos"] = last.videos;
+            printf("%s\n", QJsonDocument(row).toJson(QJsonDocument::Compact).constData());
+        } else {
+            printf("%-14d %10lld %10lld %9d %9d %12.1f %7d\n", config.channels,
+                   median(feedMs), median(totalMs), last.requests, last.failedRequests,
+                   median(peakRss) / (1024.0 * 1024.0), last.videos);
+        }
+        fflush(stdout);
+    }
+    return exitCode;
+}
@@ -0,0 +1,43 @@
+// youcpp-mock-api: serves synthetic YouTube Data API responses on localhost.
+//   YOUTUBE_API_BASE_URL=http://127.0.0.1:8089/youtube/v3 ./YouCpp
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include "MockYouTubeApi.h"
+#include <cstdio>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("youcpp-mock-api");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Local stand-in for the YouTube Data API v3");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "Listen port (0 picks a free one).", "port", "8089"},
+        {"channels", "Number of subscribed channels.", "n", "50"},
+        {"page-size", "Largest page returned for maxResults.", "n", "50"},
+        {"videos-per-channel", "Uploads per channel playlist.", "n", "5"},
+        {"latency", "Delay before each response, in ms.", "ms", "0"},
+        {"error-rate", "Fraction of requests answered with a 500.", "rate", "0"},
+        {"seed", "Seed for error injection.", "n", "1"},
+    });
+    parser.process(app);
+
+    MockYouTubeApi::Config config;
+    config.channels = parser.value("channels").toInt();
+    config.pageSize = parser.value("page-size").toInt();
+    config.videosPerChannel = parser.value("videos-per-channel").toInt();
+    config.latencyMs = parser.value("latency").toInt();
+    config.errorRate = parser.value("error-rate").toDouble();
+    config.seed = parser.value("seed").toUInt();
+
+    MockYouTubeApi api(config);
+    if (!api.listen(parser.value("port").toUShort())) {
+        fprintf(stderr, "Could not listen on port %s\n", parser.value("port").toUtf8().constData());
+        return 1;
+    }
+
+    printf("Serving %d channels on %s\n", config.channels, api.baseUrl().toUtf8().constData());
+    fflush(stdout);
+    return app.exec();
+}
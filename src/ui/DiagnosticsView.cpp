@@ -0,0 +1,301 @@
+#include "DiagnosticsView.h"
+#include "EventLoopMonitor.h"
+#include "PlayerMemoryBudget.h"
+#include "TranscriptWindow.h"
+#include "../backend/Metrics.h"
+#include "../backend/ProcessMemory.h"
+#include <QHBoxLayout>
+#include <QHash>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPainter>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char *NET_REQUESTS_PREFIX = "net.requests.";
+
+QString formatBytes(qint64 bytes) {
+    if (bytes >= 1024 * 1024) return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 0);
+}
+
+QString cacheLabel(const QString &cache) {
+    if (cache == "search") return "Search results";
+    if (cache == "video_stats") return "Video statistics";
+    if (cache == "thumbnail") return "Thumbnails (memory)";
+    if (cache == "thumbnail_http") return "Thumbnails (HTTP disk cache)";
+    if (cache == "player_http_bytes") return "Player HTTP cache (bytes)";
+    return cache;
+}
+
+QTreeWidgetItem *addRow(QTreeWidgetItem *group, const QString &label, const QString &value) {
+    auto *item = new QTreeWidgetItem(group, {label, value});
+    item->setForeground(0, QColor("#a6adc8"));
+    return item;
+}
+
+}
+
+class StallHistogram : public QWidget {
+public:
+    explicit StallHistogram(QWidget *parent = nullptr) : QWidget(parent) {
+        setMinimumHeight(160);
+    }
+
+    void setCounts(const QVector<int> &counts) {
+        if (counts == m_counts) return;
+        m_counts = counts;
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.fillRect(rect(), QColor("#181825"));
+
+        int buckets = EventLoopMonitor::HISTOGRAM_BUCKETS;
+        if (m_counts.size() != buckets) return;
+
+        const int labelHeight = 20;
+        const int countHeight = 18;
+        int peak = std::max(1, *std::max_element(m_counts.begin(), m_counts.end()));
+        double slot = double(width()) / buckets;
+        int plotHeight = height() - labelHeight - countHeight - 8;
+
+        for (int i = 0; i < buckets; ++i) {
+            int lower = EventLoopMonitor::bucketLowerBoundMs(i);
+            int upper = EventLoopMonitor::bucketLowerBoundMs(i + 1);
+            QString label = upper > 0 ? QString("%1-%2 ms").arg(lower).arg(upper) : QString("%1+ ms").arg(lower);
+
+            QRectF column(i * slot + slot * 0.15, 0, slot * 0.7, height());
+            int barHeight = m_counts[i] ? std::max(2, plotHeight * m_counts[i] / peak) : 0;
+            QRectF bar(column.left(), countHeight + 4 + plotHeight - barHeight, column.width(), barHeight);
+
+            painter.setPen(Qt::NoPen);
+            // Anything past 100 ms is a visible freeze
+            painter.setBrush(QColor(lower >= 100 ? "#f38ba8" : lower >= 50 ? "#fab387" : "#89b4fa"));
+            painter.drawRoundedRect(bar, 4, 4);
+
+            painter.setPen(QColor("#cdd6f4"));
+            painter.drawText(QRectF(column.left(), bar.top() - countHeight, column.width(), countHeight),
+                             Qt::AlignHCenter | Qt::AlignBottom, QString::number(m_counts[i]));
+            painter.setPen(QColor("#a6adc8"));
+            painter.drawText(QRectF(i * slot, height() - labelHeight, slot, labelHeight),
+                             Qt::AlignCenter, label);
+        }
+    }
+
+private:
+    QVector<int> m_counts;
+};
+
+DiagnosticsView::DiagnosticsView(QWidget *parent)
+    : QWidget(parent)
+    , m_refreshTimer(new QTimer(this))
+{
+    setObjectName("centralWidget");
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(32, 28, 32, 28);
+    layout->setSpacing(16);
+
+    QLabel *headerLabel = new QLabel("Diagnostics", this);
+    headerLabel->setStyleSheet("font-size: 22px; font-weight: 700; color: #cdd6f4;");
+    layout->addWidget(headerLabel);
+
+    QHBoxLayout *columns = new QHBoxLayout();
+    columns->setSpacing(24);
+
+    QVBoxLayout *metricsColumn = new QVBoxLayout();
+    metricsColumn->setSpacing(12);
+    QLabel *metricsLabel = new QLabel("Metrics", this);
+    metricsLabel->setStyleSheet("font-size: 16px; font-weight: 600; color: #cdd6f4;");
+    metricsColumn->addWidget(metricsLabel);
+
+    m_metrics = new QTreeWidget(this);
+    m_metrics->setColumnCount(2);
+    m_metrics->setHeaderHidden(true);
+    m_metrics->setFrameShape(QFrame::NoFrame);
+    m_metrics->setSelectionMode(QAbstractItemView::NoSelection);
+    m_metrics->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    metricsColumn->addWidget(m_metrics, 1);
+    columns->addLayout(metricsColumn, 1);
+
+    QVBoxLayout *stallsColumn = new QVBoxLayout();
+    stallsColumn->setSpacing(12);
+    QHBoxLayout *stallsHeader = new QHBoxLayout();
+    QLabel *stallsLabel = new QLabel(QString("Event-loop stalls (dispatches over %1 ms)")
+                                         .arg(EventLoopMonitor::STALL_THRESHOLD_MS), this);
+    stallsLabel->setStyleSheet("font-size: 16px; font-weight: 600; color: #cdd6f4;");
+    stallsHeader->addWidget(stallsLabel);
+    stallsHeader->addStretch();
+
+    QPushButton *resetBtn = new QPushButton("Reset", this);
+    resetBtn->setMinimumHeight(32);
+    resetBtn->setCursor(Qt::PointingHandCursor);
+    connect(resetBtn, &QPushButton::clicked, this, &DiagnosticsView::resetStalls);
+    stallsHeader->addWidget(resetBtn);
+    stallsColumn->addLayout(stallsHeader);
+
+    m_stallSummary = new QLabel(this);
+    m_stallSummary->setStyleSheet("font-size: 13px; color: #a6adc8;");
+    stallsColumn->addWidget(m_stallSummary);
+
+    m_histogram = new StallHistogram(this);
+    stallsColumn->addWidget(m_histogram);
+
+    m_offenders = new QTreeWidget(this);
+    m_offenders->setColumnCount(4);
+    m_offenders->setHeaderLabels({"Span or receiver", "Stalls", "Worst (ms)", "Total (ms)"});
+    m_offenders->setRootIsDecorated(false);
+    m_offenders->setFrameShape(QFrame::NoFrame);
+    m_offenders->setSelectionMode(QAbstractItemView::NoSelection);
+    m_offenders->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_offenders->header()->setStretchLastSection(false);
+    stallsColumn->addWidget(m_offenders, 1);
+    columns->addLayout(stallsColumn, 1);
+
+    layout->addLayout(columns, 1);
+
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsView::refresh);
+}
+
+void DiagnosticsView::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void DiagnosticsView::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+void DiagnosticsView::refresh() {
+    refreshMetrics();
+    refreshStalls();
+}
+
+QTreeWidgetItem *DiagnosticsView::addGroup(const QString &title) {
+    auto *group = new QTreeWidgetItem(m_metrics, {title});
+    QFont font = group->font(0);
+    font.setBold(true);
+    group->setFont(0, font);
+    group->setFirstColumnSpanned(true);
+    group->setExpanded(true);
+    return group;
+}
+
+void DiagnosticsView::refreshMetrics() {
+    // RSS is sampled when someone looks at it
+    static Metrics::Gauge &rss = Metrics::gauge("process.rss_bytes");
+    static Metrics::Gauge &peakRss = Metrics::gauge("process.peak_rss_bytes");
+    rss.set(ProcessMemory::residentBytes());
+    peakRss.set(ProcessMemory::peakResidentBytes());
+
+    QList<Metrics::Sample> snapshot = Metrics::snapshot();
+    QHash<QString, Metrics::Sample> samples;
+    for (const auto &sample : snapshot) samples.insert(sample.name, sample);
+    // Rows below claim their metrics; whatever is left goes under "Other"
+    auto take = [&samples](const QString &name) { return samples.take(name); };
+
+    m_metrics->clear();
+
+    QTreeWidgetItem *network = addGroup("Network");
+    for (const auto &sample : snapshot) {
+        if (!sample.name.startsWith(NET_REQUESTS_PREFIX)) continue;
+        QString host = sample.name.mid(int(std::strlen(NET_REQUESTS_PREFIX)));
+        qint64 requests = take(sample.name).value;
+        qint64 inFlight = take("net.in_flight." + host).value;
+        qint64 errors = take("net.errors." + host).value;
+        Metrics::Sample latency = take("net.latency_ms." + host);
+        addRow(network, host, QString("%1 in flight, %2 requests, %3 errors, p50 %4 ms, p95 %5 ms")
+                                  .arg(inFlight).arg(requests).arg(errors).arg(latency.p50).arg(latency.p95));
+    }
+    if (network->childCount() == 0) addRow(network, "No requests yet", QString());
+
+    QTreeWidgetItem *quota = addGroup("YouTube Data API");
+    addRow(quota, "Quota spent this session",
+           QString("%1 units (search costs 100, other calls 1)").arg(take("youtube.quota_units").value));
+
+    QTreeWidgetItem *caches = addGroup("Caches");
+    for (const auto &sample : snapshot) {
+        if (!sample.name.startsWith("cache.") || !sample.name.endsWith(".hits")) continue;
+        QString cache = sample.name.section('.', 1, -2);
+        qint64 hits = take(sample.name).value;
+        qint64 misses = take("cache." + cache + ".misses").value;
+        qint64 total = hits + misses;
+        addRow(caches, cacheLabel(cache), total == 0 ? QString("no lookups yet")
+               : QString("%1% hit rate (%2 of %3)").arg(100.0 * hits / total, 0, 'f', 1).arg(hits).arg(total));
+    }
+
+    QTreeWidgetItem *memory = addGroup("Memory");
+    addRow(memory, "Process RSS", QString("%1 (peak %2)")
+                                      .arg(formatBytes(take("process.rss_bytes").value))
+                                      .arg(formatBytes(take("process.peak_rss_bytes").value)));
+    addRow(memory, "Thumbnails in memory", QString("%1 (%2)")
+                                               .arg(take("thumbnails.in_memory").value)
+                                               .arg(formatBytes(take("thumbnails.memory_bytes").value)));
+    addRow(memory, "Player renderers", formatBytes(take("player.renderer_bytes").value));
+
+    qint64 hibernated = take("player.hibernated_tabs").value;
+    take("player.tabs");
+    QList<PlayerMemoryBudget::TabUsage> usage = m_memoryBudget ? m_memoryBudget->usage() : QList<PlayerMemoryBudget::TabUsage>();
+    QTreeWidgetItem *players = addGroup(QString("Player tabs (%1, %2 hibernated)").arg(usage.size()).arg(hibernated));
+    for (const auto &u : usage) {
+        if (!u.tab) continue;
+        QString state = u.tab->isHibernating() ? QString("hibernated")
+                      : u.bytes > 0 ? QString("~%1 renderer memory").arg(formatBytes(u.bytes))
+                                    : QString("no renderer yet");
+        addRow(players, u.tab->title(), state);
+    }
+
+    if (!samples.isEmpty()) {
+        QTreeWidgetItem *other = addGroup("Other");
+        for (const auto &sample : snapshot) {
+            if (!samples.contains(sample.name)) continue;
+            QString value = sample.kind == Metrics::Sample::HistogramSample
+                ? QString("n=%1, p50 %2, p95 %3, max %4").arg(sample.value).arg(sample.p50).arg(sample.p95).arg(sample.max)
+                : QString::number(sample.value);
+            addRow(other, sample.name, value);
+        }
+    }
+}
+
+void DiagnosticsView::refreshStalls() {
+    EventLoopMonitor *monitor = EventLoopMonitor::instance();
+    if (!monitor) {
+        m_stallSummary->setText("Event-loop monitoring is not active in this process");
+        return;
+    }
+
+    m_stallSummary->setText(QString("%1 dispatches, %2 stalls, %3 ms stalled in total, worst %4 ms")
+                                .arg(monitor->dispatchCount())
+                                .arg(monitor->stallCount())
+                                .arg(monitor->stalledUs() / 1000)
+                                .arg(monitor->worstStallUs() / 1000.0, 0, 'f', 1));
+    m_histogram->setCounts(monitor->histogram());
+
+    m_offenders->clear();
+    for (const auto &offender : monitor->worstOffenders(OFFENDER_ROWS)) {
+        auto *item = new QTreeWidgetItem(m_offenders);
+        item->setText(0, offender.source);
+        item->setText(1, QString::number(offender.stalls));
+        item->setText(2, QString::number(offender.worstUs / 1000.0, 'f', 1));
+        item->setText(3, QString::number(offender.totalUs / 1000.0, 'f', 1));
+        for (int column = 1; column < 4; ++column) item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+    }
+}
+
+void DiagnosticsView::resetStalls() {
+    if (EventLoopMonitor *monitor = EventLoopMonitor::instance()) monitor->reset();
+    refreshStalls();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <QPointer>
+#include <QWidget>
+
+class PlayerMemoryBudget;
+class QLabel;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class StallHistogram;
+
+// Developer tab (Ctrl+Shift+D): live metrics from the Metrics registry (network, quota, caches,
+// memory, player tabs) next to GUI event-loop stalls. Refreshes once a second while visible.
+class DiagnosticsView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsView(QWidget *parent = nullptr);
+
+    // Source of the per-tab renderer memory rows
+    void setPlayerMemoryBudget(PlayerMemoryBudget *budget) { m_memoryBudget = budget; }
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void resetStalls();
+
+private:
+    void refreshMetrics();
+    void refreshStalls();
+    QTreeWidgetItem *addGroup(const QString &title);
+
+    QTimer *m_refreshTimer;
+    QPointer<PlayerMemoryBudget> m_memoryBudget;
+    QTreeWidget *m_metrics;
+    QLabel *m_stallSummary;
+    StallHistogram *m_histogram;
+    QTreeWidget *m_offenders;
+
+    static const int REFRESH_INTERVAL_MS = 1000;
+    static const int OFFENDER_ROWS = 20;
+};
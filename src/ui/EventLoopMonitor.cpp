@@ -0,0 +1,150 @@
+#include "EventLoopMonitor.h"
+#include "../backend/Log.h"
+#include "../backend/Trace.h"
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QThread>
+#include <algorithm>
+
+// One frame at 60 Hz
+const int EventLoopMonitor::STALL_THRESHOLD_MS = 16;
+const int EventLoopMonitor::HISTOGRAM_BUCKETS = 7;
+
+EventLoopMonitor *EventLoopMonitor::s_instance = nullptr;
+
+namespace {
+
+const int BUCKET_BOUNDS_MS[] = {16, 33, 50, 100, 250, 500, 1000};
+
+// receiver is null once the dispatch deleted it (DeferredDelete, a slot deleting its sender);
+// className was taken before the dispatch and stays valid, it's static metadata
+QString describe(const char *className, QObject *receiver, QEvent::Type eventType) {
+    QString source = QString::fromLatin1(className);
+    if (receiver && !receiver->objectName().isEmpty()) {
+        source += '#' + receiver->objectName();
+    } else if (receiver && receiver->parent()) {
+        // Timers and replies are anonymous; their owner says more
+        source += QString(" in %1").arg(QString::fromLatin1(receiver->parent()->metaObject()->className()));
+    }
+    const char *type = QMetaEnum::fromType<QEvent::Type>().valueToKey(eventType);
+    return source + ' ' + (type ? QString::fromLatin1(type) : QString::number(eventType));
+}
+
+}
+
+EventLoopMonitor::EventLoopMonitor(QObject *parent)
+    : QObject(parent)
+    , m_histogram(HISTOGRAM_BUCKETS, 0)
+{
+    s_instance = this;
+    Trace::setSpanAttribution(true);
+
+    // A loop that wakes or goes idle at a deeper level is nested inside the dispatch in progress
+    if (QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(thread())) {
+        connect(dispatcher, &QAbstractEventDispatcher::awake, this, [this]() { m_loopDepth = m_depth; });
+        connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, [this]() { m_loopDepth = m_depth; });
+    }
+}
+
+EventLoopMonitor::~EventLoopMonitor() {
+    if (s_instance == this) s_instance = nullptr;
+    Trace::setSpanAttribution(false);
+}
+
+EventLoopMonitor *EventLoopMonitor::instance() {
+    return s_instance;
+}
+
+bool EventLoopMonitor::deliver(QApplication *app, QObject *receiver, QEvent *event) {
+    if (QThread::currentThread() != thread()) return app->QApplication::notify(receiver, event);
+
+    // Anything sent from inside a dispatch is part of its cost
+    if (m_depth++ != m_loopDepth) {
+        bool result = app->QApplication::notify(receiver, event);
+        --m_depth;
+        return result;
+    }
+
+    Trace::takeLongestSpan(nullptr);
+    // The receiver may not survive its own dispatch
+    const char *className = receiver->metaObject()->className();
+    QEvent::Type eventType = event->type();
+    QPointer<QObject> guard(receiver);
+    QElapsedTimer timer;
+    timer.start();
+    bool result = app->QApplication::notify(receiver, event);
+    qint64 elapsedNs = timer.nsecsElapsed();
+    --m_depth;
+
+    if (m_loopDepth > m_depth) {
+        // Blocked in a nested loop, not stalled
+        m_loopDepth = m_depth;
+        return result;
+    }
+
+    ++m_dispatches;
+    if (elapsedNs >= STALL_THRESHOLD_MS * 1000000LL) record(className, guard.data(), eventType, elapsedNs);
+    return result;
+}
+
+void EventLoopMonitor::record(const char *className, QObject *receiver, QEvent::Type eventType, qint64 elapsedNs) {
+    qint64 spanNs = 0;
+    const char *span = Trace::takeLongestSpan(&spanNs);
+    QString source = span && spanNs * 2 >= elapsedNs
+        ? QString::fromLatin1(span)
+        : describe(className, receiver, eventType);
+
+    qint64 elapsedUs = elapsedNs / 1000;
+    ++m_stalls;
+    m_stalledUs += elapsedUs;
+    m_worstUs = std::max(m_worstUs, elapsedUs);
+
+    int bucket = HISTOGRAM_BUCKETS - 1;
+    while (bucket > 0 && elapsedUs < BUCKET_BOUNDS_MS[bucket] * 1000LL) --bucket;
+    ++m_histogram[bucket];
+
+    Offender &offender = m_offenders[source];
+    offender.source = source;
+    ++offender.stalls;
+    offender.totalUs += elapsedUs;
+    offender.worstUs = std::max(offender.worstUs, elapsedUs);
+
+    LOG_DEBUG("EventLoop", "Stalled %lld ms in %s", elapsedUs / 1000, source);
+}
+
+int EventLoopMonitor::bucketLowerBoundMs(int bucket) {
+    return bucket < HISTOGRAM_BUCKETS ? BUCKET_BOUNDS_MS[bucket] : -1;
+}
+
+QList<EventLoopMonitor::Offender> EventLoopMonitor::worstOffenders(int limit) const {
+    QList<Offender> offenders = m_offenders.values();
+    std::sort(offenders.begin(), offenders.end(), [](const Offender &a, const Offender &b) {
+        return a.totalUs > b.totalUs;
+    });
+    if (offenders.size() > limit) offenders.resize(limit);
+    return offenders;
+}
+
+void EventLoopMonitor::reset() {
+    m_dispatches = 0;
+    m_stalls = 0;
+    m_stalledUs = 0;
+    m_worstUs = 0;
+    m_histogram.fill(0);
+    m_offenders.clear();
+}
+
+MonitoredApplication::MonitoredApplication(int &argc, char **argv)
+    : QApplication(argc, argv)
+{
+    // Assigned after construction: creating the monitor sends events through notify()
+    m_monitor = new EventLoopMonitor(this);
+}
+
+bool MonitoredApplication::notify(QObject *receiver, QEvent *event) {
+    if (!m_monitor) return QApplication::notify(receiver, event);
+    return m_monitor->deliver(this, receiver, event);
+}
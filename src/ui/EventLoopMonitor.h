@@ -0,0 +1,76 @@
+#pragma once
+#include <QApplication>
+#include <QEvent>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+// Times every event the GUI thread's loop dispatches and records the ones that take longer than
+// a 60 Hz frame. A stall is charged to the longest outermost Trace::Scope that ran inside it when
+// that scope covers most of the stall, otherwise to the receiver's class and the event type.
+// Events sent synchronously from inside a dispatch count towards it; a dispatch that ran a nested
+// loop (modal dialog, context menu) is skipped and the nested loop's own dispatches are timed.
+class EventLoopMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    struct Offender {
+        QString source;
+        int stalls = 0;
+        qint64 totalUs = 0;
+        qint64 worstUs = 0;
+    };
+
+    explicit EventLoopMonitor(QObject *parent = nullptr);
+    ~EventLoopMonitor();
+
+    // The monitor installed by MonitoredApplication, or null (benchmarks, plain QApplication)
+    static EventLoopMonitor *instance();
+
+    // Delivers the event through QApplication::notify, timing it if it's a GUI-thread dispatch
+    bool deliver(QApplication *app, QObject *receiver, QEvent *event);
+
+    qint64 dispatchCount() const { return m_dispatches; }
+    qint64 stallCount() const { return m_stalls; }
+    qint64 stalledUs() const { return m_stalledUs; }
+    qint64 worstStallUs() const { return m_worstUs; }
+
+    // Stall counts; bucket i covers [bucketLowerBoundMs(i), bucketLowerBoundMs(i + 1))
+    const QVector<int> &histogram() const { return m_histogram; }
+    static int bucketLowerBoundMs(int bucket);
+    // Sorted by total time stalled
+    QList<Offender> worstOffenders(int limit) const;
+    void reset();
+
+    static const int STALL_THRESHOLD_MS;
+    static const int HISTOGRAM_BUCKETS;
+
+private:
+    // receiver is null when the dispatch deleted it
+    void record(const char *className, QObject *receiver, QEvent::Type eventType, qint64 elapsedNs);
+
+    int m_depth = 0;
+    int m_loopDepth = 0;
+
+    qint64 m_dispatches = 0;
+    qint64 m_stalls = 0;
+    qint64 m_stalledUs = 0;
+    qint64 m_worstUs = 0;
+    QVector<int> m_histogram;
+    QHash<QString, Offender> m_offenders;
+
+    static EventLoopMonitor *s_instance;
+};
+
+// QApplication whose event deliveries go through an EventLoopMonitor
+class MonitoredApplication : public QApplication {
+public:
+    MonitoredApplication(int &argc, char **argv);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+
+private:
+    EventLoopMonitor *m_monitor = nullptr;
+};
@@ -1,12 +1,46 @@
 #include "MainWindow.h"
+#include "../backend/Log.h"
 #include "TranscriptWindow.h"
+#include "PlayerViewPool.h"
+#include "PlayerView.h"
+#include "PlayerMemoryBudget.h"
+#include "DiagnosticsView.h"
+#include "../backend/FeedSnapshot.h"
+#include "../backend/Metrics.h"
+#include "../backend/TranscriptIndex.h"
+#include "../backend/Trace.h"
+#include <QDesktopServices>
+#include <QEvent>
 #include <QMessageBox>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <cstdio>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QToolButton>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+MainWindow::MainWindow(GoogleAuth *auth, YouTubeService *service, QWidget *parent)
+    : QMainWindow(parent)
+    , m_service(service)
+    , m_auth(auth)
+    , m_playerPool(new PlayerViewPool(this))
+    , m_memoryBudget(new PlayerMemoryBudget(this))
+    , m_thumbnailNet(new QNetworkAccessManager(this))
+    , m_hoverIntentTimer(new QTimer(this))
+{
+    auto *thumbnailDiskCache = new QNetworkDiskCache(m_thumbnailNet);
+    thumbnailDiskCache->setCacheDirectory(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails");
+    thumbnailDiskCache->setMaximumCacheSize(qint64(THUMBNAIL_DISK_CACHE_MB) * 1024 * 1024);
+    m_thumbnailNet->setCache(thumbnailDiskCache);
+    m_thumbnailCache.setMaxCost(THUMBNAIL_MEMORY_KB);
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     m_tabs = new QTabWidget(this);
     m_tabs->setTabsClosable(true);
     m_tabs->setMovable(true);
@@ -14,24 +48,56 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     
     connect(m_tabs, &QTabWidget::tabCloseRequested, this, [this](int index) {
         QWidget* w = m_tabs->widget(index);
-        if (w != m_searchTab && w != m_homeTab) { 
+        if (w == m_diagnosticsView) {
+            m_tabs->removeTab(index);
+            return;
+        }
+        if (w != m_searchTab && w != m_homeTab && w != m_recommendationsTab && w != m_transcriptsTab) { 
             m_tabs->removeTab(index);
             w->deleteLater(); 
         }
     });
 
-    setCentralWidget(m_tabs);
+    connect(m_tabs, &QTabWidget::currentChanged, this, [this](int index) {
+        if (m_tabs->widget(index) == m_recommendationsTab) {
+            m_service->fetchRecommendations();
+        }
+        if (auto *tw = qobject_cast<TranscriptWindow *>(m_tabs->widget(index))) {
+            m_memoryBudget->touch(tw);
+        }
+    });
 
-    m_auth = new GoogleAuth(this);
-    m_service = new YouTubeService(this);
+    connect(m_memoryBudget, &PlayerMemoryBudget::usageSampled, this,
+            [this](const QList<PlayerMemoryBudget::TabUsage> &usage, qint64 totalBytes) {
+        static Metrics::Gauge &tabs = Metrics::gauge("player.tabs");
+        static Metrics::Gauge &hibernated = Metrics::gauge("player.hibernated_tabs");
+        static Metrics::Gauge &rendererBytes = Metrics::gauge("player.renderer_bytes");
+        tabs.set(usage.size());
+        hibernated.set(std::count_if(usage.begin(), usage.end(), [](const PlayerMemoryBudget::TabUsage &u) {
+            return u.tab && u.tab->isHibernating();
+        }));
+        rendererBytes.set(totalBytes);
 
-    QString clientId = qEnvironmentVariable("GOOGLE_CLIENT_ID");
-    QString clientSecret = qEnvironmentVariable("GOOGLE_CLIENT_SECRET");
-    m_auth->setCredentials(clientId, clientSecret);
+        for (const auto &u : usage) {
+            int index = m_tabs->indexOf(u.tab);
+            if (index < 0) continue;
+            m_tabs->setTabToolTip(index, u.tab->isHibernating()
+                ? QString("Hibernated")
+                : QString("Renderer memory: ~%1 MB").arg(u.bytes / (1024 * 1024)));
+        }
+    });
+
+    setCentralWidget(m_tabs);
+
+    m_auth->setParent(this);
+    m_service->setParent(this);
 
     setupHomeTab();
     m_tabs->addTab(m_homeTab, "Home");
 
+    setupRecommendationsTab();
+    m_tabs->addTab(m_recommendationsTab, "For You");
+
     m_searchTab = new QWidget();
     m_searchTab->setObjectName("centralWidget");
     
@@ -69,27 +135,108 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     m_videoList->setSelectionMode(QAbstractItemView::SingleSelection);
     m_videoList->setAlternatingRowColors(false);
 
+    // Typeahead: local suggestions per keystroke, a network search once typing pauses
+    m_searchDebounce = new QTimer(this);
+    m_searchDebounce->setSingleShot(true);
+    m_searchDebounce->setInterval(SEARCH_DEBOUNCE_MS);
+    connect(m_searchDebounce, &QTimer::timeout, this, &MainWindow::runTypeaheadSearch);
+
+    m_suggestionModel = new QStringListModel(this);
+    m_searchCompleter = new QCompleter(m_suggestionModel, this);
+    m_searchCompleter->setWidget(m_searchInput);
+    m_searchCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    m_searchCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+    connect(m_searchCompleter, QOverload<const QString &>::of(&QCompleter::activated), this, [this](const QString &text) {
+        m_searchInput->setText(text);
+        performSearch();
+    });
+
     searchLayout->addWidget(m_searchInput, 1); 
     searchLayout->addWidget(m_searchBtn);
     mainLayout->addLayout(searchLayout);
+
+    m_searchStatus = new QLabel(this);
+    m_searchStatus->setStyleSheet("font-size: 13px; color: #a6adc8;");
+    m_searchStatus->hide();
+    mainLayout->addWidget(m_searchStatus);
     mainLayout->addWidget(m_videoList, 1);
 
+    m_videoIndexSaveTimer = new QTimer(this);
+    m_videoIndexSaveTimer->setSingleShot(true);
+    m_videoIndexSaveTimer->setInterval(VIDEO_INDEX_SAVE_DELAY_MS);
+    connect(m_videoIndexSaveTimer, &QTimer::timeout, this, &MainWindow::saveVideoIndex);
+
+    // Read off the UI thread; videos shown meanwhile are merged in when it lands
+    connect(&m_videoIndexLoad, &QFutureWatcher<VideoIndex>::finished, this, [this]() {
+        VideoIndex loaded = m_videoIndexLoad.result();
+        for (const auto &doc : m_videoIndex.documents()) loaded.add(doc.video, doc.seenAt);
+        bool shownWhileLoading = m_videoIndex.size() > 0;
+        m_videoIndex = std::move(loaded);
+        m_videoIndexLoaded = true;
+
+        QList<VideoResult> seen;
+        seen.reserve(m_videoIndex.size());
+        for (const auto &doc : m_videoIndex.documents()) seen.append(doc.video);
+        m_service->addRecommendationCandidates(seen);
+        Metrics::gauge("local_index.videos").set(m_videoIndex.size());
+        if (shownWhileLoading) m_videoIndexSaveTimer->start();
+    });
+    m_videoIndexLoad.setFuture(QtConcurrent::run(&VideoIndex::load, videoIndexPath()));
+
     m_tabs->addTab(m_searchTab, "Search");
 
+    setupTranscriptsTab();
+    m_tabs->addTab(m_transcriptsTab, "Transcripts");
+
+    m_hoverIntentTimer->setSingleShot(true);
+    m_hoverIntentTimer->setInterval(HOVER_INTENT_MS);
+    connect(m_hoverIntentTimer, &QTimer::timeout, this, &MainWindow::onHoverIntent);
+    setupHoverPrefetch(m_videoList);
+    setupHoverPrefetch(m_feedList);
+    setupHoverPrefetch(m_recommendationsList);
+
+    connect(m_searchInput, &QLineEdit::textEdited, this, &MainWindow::onSearchEdited);
     connect(m_searchInput, &QLineEdit::returnPressed, this, &MainWindow::performSearch);
     connect(m_searchBtn, &QPushButton::clicked, this, &MainWindow::performSearch);
     connect(m_videoList, &QListWidget::itemClicked, this, &MainWindow::openVideoFromItem);
     connect(m_videoList, &QListWidget::customContextMenuRequested, this, &MainWindow::showContextMenu);
     
     connect(m_service, &YouTubeService::searchResultsReady, this, &MainWindow::handleSearchResults);
+    connect(m_service, &YouTubeService::searchResultsAppended, this, &MainWindow::appendSearchResults);
+    connect(m_service, &YouTubeService::searchFailed, this, &MainWindow::onSearchFailed);
+    connect(m_videoList->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::maybeLoadMoreResults);
+    connect(m_videoList->verticalScrollBar(), &QScrollBar::rangeChanged, this, &MainWindow::maybeLoadMoreResults);
     connect(m_service, &YouTubeService::subscriptionFeedReady, this, &MainWindow::handleSubscriptionFeed);
     connect(m_service, &YouTubeService::recommendationsReady, this, &MainWindow::handleRecommendations);
     connect(m_service, &YouTubeService::errorOccurred, this, &MainWindow::showError);
+    connect(m_service, &YouTubeService::transcriptReady, this, &MainWindow::indexTranscript);
+    connect(m_service, &YouTubeService::videoStatisticsReady, this, &MainWindow::applyVideoStatistics);
     
+    connect(m_auth, &GoogleAuth::authorizationUrlReady, this, [](const QUrl &url) {
+        QDesktopServices::openUrl(url);
+    });
     connect(m_auth, &GoogleAuth::authenticated, this, &MainWindow::onAuthenticated);
     connect(m_auth, &GoogleAuth::authenticationFailed, this, &MainWindow::onAuthFailed);
     connect(m_auth, &GoogleAuth::loggedOut, this, &MainWindow::onLoggedOut);
 
+    // Player cookies/cache persist across tabs now; wiping them is an explicit choice
+    m_clearPlayerDataAction = new QAction("Clear Player Cookies && Cache", this);
+    m_clearPlayerDataAction->setShortcut(QKeySequence("Ctrl+Shift+Del"));
+    connect(m_clearPlayerDataAction, &QAction::triggered, this, &MainWindow::clearPlayerData);
+    addAction(m_clearPlayerDataAction);
+
+    QAction *diagnosticsAction = new QAction("Diagnostics", this);
+    diagnosticsAction->setShortcut(QKeySequence("Ctrl+Shift+D"));
+    connect(diagnosticsAction, &QAction::triggered, this, &MainWindow::showDiagnostics);
+    addAction(diagnosticsAction);
+
+    // Shortcuts aren't discoverable; keep the panel one click away next to the tabs
+    auto *diagnosticsBtn = new QToolButton(m_tabs);
+    diagnosticsBtn->setDefaultAction(diagnosticsAction);
+    diagnosticsBtn->setToolTip("Diagnostics (Ctrl+Shift+D)");
+    diagnosticsBtn->setAutoRaise(true);
+    m_tabs->setCornerWidget(diagnosticsBtn, Qt::TopRightCorner);
+
     setWindowTitle("YouCpp - YouTube Video Player");
     resize(1100, 850);
     setMinimumSize(800, 600);
@@ -100,9 +247,22 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     }
 }
 
+MainWindow::~MainWindow() {
+    // Player tabs hand their views back to m_playerPool on destruction; the pool is an earlier
+    // child than m_tabs and would be gone by the time QObject deletes them. Closed tabs still
+    // waiting on deleteLater() are children too.
+    qDeleteAll(findChildren<TranscriptWindow *>());
+
+    if (m_videoIndexSaveTimer->isActive()) saveVideoIndex();
+    // Pending appends finish, then the delta is written out as a segment
+    m_indexThreads.waitForDone();
+    delete m_transcriptIndex;
+}
+
 class VideoCard : public QWidget {
 public:
-    VideoCard(const QString &title, const QString &channel, QWidget *parent = nullptr) : QWidget(parent) {
+    VideoCard(const QString &title, const QString &channel, QWidget *parent = nullptr)
+        : QWidget(parent), m_channelName(channel) {
         QVBoxLayout *layout = new QVBoxLayout(this);
         layout->setContentsMargins(4, 4, 4, 4); 
         layout->setSpacing(0);
@@ -150,10 +310,40 @@ public:
         }
     }
 
+    // Appended to the channel line, which keeps the card height unchanged
+    void setStats(const VideoResult &vid) {
+        QStringList parts{m_channelName};
+        if (vid.viewCount > 0) parts << formatViews(vid.viewCount);
+        if (!vid.duration.isEmpty()) parts << formatDuration(vid.duration);
+        if (parts.size() > 1) m_channel->setText(parts.join(QStringLiteral("  \u00b7  ")));
+    }
+
 private:
+    static QString formatViews(unsigned long long views) {
+        if (views >= 1000000000ULL) return QString("%1B views").arg(views / 1e9, 0, 'f', 1);
+        if (views >= 1000000ULL) return QString("%1M views").arg(views / 1e6, 0, 'f', 1);
+        if (views >= 1000ULL) return QString("%1K views").arg(views / 1e3, 0, 'f', views >= 10000ULL ? 0 : 1);
+        return QString("%1 views").arg(views);
+    }
+
+    // ISO 8601 "PT1H2M3S" -> "1:02:03"
+    static QString formatDuration(const QString &iso) {
+        static const QRegularExpression pattern("^P(?:(\\d+)D)?T?(?:(\\d+)H)?(?:(\\d+)M)?(?:(\\d+)S)?$");
+        QRegularExpressionMatch match = pattern.match(iso);
+        if (!match.hasMatch()) return QString();
+        int hours = match.captured(1).toInt() * 24 + match.captured(2).toInt();
+        int minutes = match.captured(3).toInt();
+        int seconds = match.captured(4).toInt();
+        if (hours > 0) {
+            return QString("%1:%2:%3").arg(hours).arg(minutes, 2, 10, QChar('0')).arg(seconds, 2, 10, QChar('0'));
+        }
+        return QString("%1:%2").arg(minutes).arg(seconds, 2, 10, QChar('0'));
+    }
+
     QLabel *m_thumbnail;
     QLabel *m_title;
     QLabel *m_channel;
+    QString m_channelName;
 };
 
 void MainWindow::setupHomeTab() {
@@ -270,16 +460,14 @@ void MainWindow::updateAuthUI() {
 }
 
 void MainWindow::onSignInClicked() {
-    printf("[YouCpp] Sign-in button clicked\n");
-    fflush(stdout);
+    LOG_INFO("YouCpp", "Sign-in button clicked");
     m_signInBtn->setEnabled(false);
     m_signInBtn->setText("Signing in...");
     m_auth->startLogin();
 }
 
 void MainWindow::onAuthenticated() {
-    printf("[YouCpp] Authentication successful!\n");
-    fflush(stdout);
+    LOG_INFO("YouCpp", "Authentication successful!");
     m_signInBtn->setEnabled(true);
     m_signInBtn->setText("Sign In with Google");
     
@@ -287,38 +475,80 @@ void MainWindow::onAuthenticated() {
     updateAuthUI();
     
     // Fetch personalized content
-    printf("[YouCpp] Fetching subscription feed...\n");
-    fflush(stdout);
-    m_feedList->clear();
-    QListWidgetItem *loadingItem = new QListWidgetItem("Loading your feed...", m_feedList);
-    loadingItem->setFlags(loadingItem->flags() & ~Qt::ItemIsSelectable);
-    loadingItem->setTextAlignment(Qt::AlignCenter);
-    loadingItem->setForeground(QColor("#a6adc8"));
+    LOG_INFO("YouCpp", "Fetching subscription feed...");
+    if (!m_snapshotShown) {
+        m_feedList->clear();
+        QListWidgetItem *loadingItem = new QListWidgetItem("Loading your feed...", m_feedList);
+        loadingItem->setFlags(loadingItem->flags() & ~Qt::ItemIsSelectable);
+        loadingItem->setTextAlignment(Qt::AlignCenter);
+        loadingItem->setForeground(QColor("#a6adc8"));
+    }
     
     m_service->fetchSubscriptionsFeed();
 }
 
 void MainWindow::onAuthFailed(const QString &error) {
-    printf("[YouCpp] Authentication FAILED: %s\n", error.toUtf8().constData());
-    fflush(stdout);
+    LOG_ERROR("YouCpp", "Authentication FAILED: %s", error);
     m_signInBtn->setEnabled(true);
     m_signInBtn->setText("Sign In with Google");
     QMessageBox::warning(this, "Authentication Failed", error);
 }
 
 void MainWindow::onLoggedOut() {
+    m_liveFeedShown = false;
+    m_snapshotShown = false;
+    FeedSnapshot::clear();
     updateAuthUI();
 }
 
 void MainWindow::handleSubscriptionFeed(const QList<VideoResult> &results) {
+    m_liveFeedShown = true;
     populateVideoList(m_feedList, results);
+    indexVideos(results);
+    if (m_tabs->currentWidget() == m_recommendationsTab) {
+        m_service->fetchRecommendations();
+    }
+    emit feedShown(results.size(), false);
+
+    if (!results.isEmpty()) {
+        (void)QtConcurrent::run(&FeedSnapshot::save, results);
+    }
+}
+
+void MainWindow::showFeedSnapshot(const QList<VideoResult> &results) {
+    if (m_liveFeedShown) return;
+    if (!m_auth->isAuthenticated() && !m_auth->isRefreshing()) return;
+
+    QList<VideoResult> visible;
+    for (const auto &vid : results) {
+        if (!m_service->isChannelMuted(vid.channelId)) {
+            visible.append(vid);
+        }
+    }
+
+    m_snapshotShown = true;
+    m_homeStack->setCurrentWidget(m_feedPage);
+    populateVideoList(m_feedList, visible);
+    indexVideos(visible);
+    emit feedShown(visible.size(), true);
 }
 
 void MainWindow::handleRecommendations(const QList<VideoResult> &results) {
-    populateVideoList(m_feedList, results);
+    // Same videos and order as last time: keep the cards (and the scroll position)
+    QStringList ids;
+    for (const auto &vid : results) ids.append(vid.id);
+    if (!results.isEmpty() && ids == m_recommendationIds) return;
+    m_recommendationIds = ids;
+
+    populateVideoList(m_recommendationsList, results);
+    m_recommendationsSummary->setText(results.isEmpty()
+        ? QString("Sign in or watch a few videos; recommendations come from channels you subscribe to or keep watching")
+        : QString("%1 videos from channels you subscribe to or keep watching").arg(results.size()));
 }
 
 void MainWindow::populateVideoList(QListWidget *list, const QList<VideoResult> &results) {
+    Trace::Scope span("ui", "populateVideoList");
+    span.setArg("videos", results.size());
     list->clear();
     
     if (results.isEmpty()) {
@@ -329,13 +559,20 @@ void MainWindow::populateVideoList(QListWidget *list, const QList<VideoResult> &
         emptyItem->setForeground(QColor("#a6adc8"));
         return;
     }
-    
+
+    appendVideoCards(list, results);
+}
+
+void MainWindow::appendVideoCards(QListWidget *list, const QList<VideoResult> &results) {
+    Trace::Scope span("ui", "appendVideoCards");
+    span.setArg("videos", results.size());
     for (const auto &vid : results) {
         QListWidgetItem *item = new QListWidgetItem(list);
         
         item->setSizeHint(QSize(310, 270)); 
         
         VideoCard *cardWidget = new VideoCard(vid.title, vid.channel, list);
+        cardWidget->setStats(vid);
         list->setItemWidget(item, cardWidget);
         
         item->setData(Qt::UserRole, vid.id);
@@ -344,20 +581,75 @@ void MainWindow::populateVideoList(QListWidget *list, const QList<VideoResult> &
         item->setData(Qt::UserRole + 3, vid.channelId);
         item->setToolTip(QString("Click to watch: %1").arg(vid.title));
         
-        QNetworkAccessManager *net = new QNetworkAccessManager(this);
-        QNetworkReply *reply = net->get(QNetworkRequest(QUrl(vid.thumbnailUrl)));
-        connect(reply, &QNetworkReply::finished, [reply, cardWidget, net]() {
-            if (reply->error() == QNetworkReply::NoError) {
-                QPixmap pixmap;
-                pixmap.loadFromData(reply->readAll());
-                cardWidget->setThumbnail(pixmap);
-            }
-            reply->deleteLater();
-            net->deleteLater();
+        // The list may be repopulated (typeahead, paging) before the thumbnail lands
+        loadThumbnail(vid.thumbnailUrl, cardWidget, [cardWidget](const QPixmap &pixmap) {
+            cardWidget->setThumbnail(pixmap);
         });
     }
 }
 
+void MainWindow::applyVideoStatistics(const QList<VideoResult> &videos) {
+    QHash<QString, const VideoResult *> byId;
+    for (const auto &vid : videos) {
+        byId.insert(vid.id, &vid);
+        m_videoIndex.updateStatistics(vid);
+    }
+    if (m_videoIndexLoaded) m_videoIndexSaveTimer->start();
+
+    for (QListWidget *list : {m_videoList, m_feedList, m_recommendationsList}) {
+        for (int i = 0; i < list->count(); ++i) {
+            QListWidgetItem *item = list->item(i);
+            const VideoResult *vid = byId.value(item->data(Qt::UserRole).toString());
+            // Only VideoCards are set as item widgets
+            if (auto *card = static_cast<VideoCard *>(list->itemWidget(item)); vid && card) {
+                card->setStats(*vid);
+            }
+        }
+    }
+}
+
+void MainWindow::loadThumbnail(const QString &url, QObject *target, std::function<void(const QPixmap &)> apply) {
+    static Metrics::Counter &memoryHits = Metrics::counter("cache.thumbnail.hits");
+    static Metrics::Counter &memoryMisses = Metrics::counter("cache.thumbnail.misses");
+    static Metrics::Counter &httpHits = Metrics::counter("cache.thumbnail_http.hits");
+    static Metrics::Counter &httpMisses = Metrics::counter("cache.thumbnail_http.misses");
+    static Metrics::Gauge &inMemory = Metrics::gauge("thumbnails.in_memory");
+    static Metrics::Gauge &memoryBytes = Metrics::gauge("thumbnails.memory_bytes");
+
+    if (const QPixmap *cached = m_thumbnailCache.object(url)) {
+        memoryHits.add();
+        apply(*cached);
+        return;
+    }
+    memoryMisses.add();
+
+    QNetworkRequest request{QUrl(url)};
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    QNetworkReply *reply = m_thumbnailNet->get(request);
+    Trace::traceReply(reply, "thumbnail");
+    Metrics::trackReply(reply);
+    QPointer<QObject> guard = target;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, url, guard, apply]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) return;
+        (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() ? httpHits : httpMisses).add();
+
+        QPixmap pixmap;
+        {
+            TRACE_SCOPE("ui", "thumbnail decode");
+            pixmap.loadFromData(reply->readAll());
+        }
+        if (pixmap.isNull()) return;
+
+        int costKb = std::max<qint64>(1, qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 / 1024);
+        m_thumbnailCache.insert(url, new QPixmap(pixmap), costKb);
+        inMemory.set(m_thumbnailCache.count());
+        memoryBytes.set(qint64(m_thumbnailCache.totalCost()) * 1024);
+
+        if (guard) apply(pixmap);
+    });
+}
+
 void MainWindow::showContextMenu(const QPoint &pos) {
     QListWidget *list = qobject_cast<QListWidget*>(sender());
     if (!list) return;
@@ -368,6 +660,12 @@ void MainWindow::showContextMenu(const QPoint &pos) {
     QMenu menu(this);
     QAction *openAction = menu.addAction("Open in New Tab");
     connect(openAction, &QAction::triggered, [this, item]() { openVideoFromItem(item); });
+
+    TranscriptWindow *target = queueTarget();
+    QAction *queueAction = menu.addAction(target ? QString("Add to Queue in '%1'").arg(target->title().left(30)) : QString("Add to Queue"));
+    connect(queueAction, &QAction::triggered, [this, item]() {
+        queueVideo(item->data(Qt::UserRole).toString(), item->data(Qt::UserRole + 1).toString());
+    });
     
     QString channelId = item->data(Qt::UserRole + 3).toString();
     QString channelName = item->data(Qt::UserRole + 2).toString();
@@ -391,6 +689,9 @@ void MainWindow::showContextMenu(const QPoint &pos) {
         });
     }
     
+    menu.addSeparator();
+    menu.addAction(m_clearPlayerDataAction);
+
     menu.exec(list->mapToGlobal(pos));
 }
 
@@ -402,42 +703,391 @@ void MainWindow::openVideoFromItem(QListWidgetItem *item) {
     }
 }
 
-void MainWindow::openVideoById(const QString &videoId, const QString &title) {
-    auto *tw = new TranscriptWindow(videoId, title, this);
+void MainWindow::openVideoById(const QString &videoId, const QString &title, double startSeconds) {
+    // The prefetched view (if any) is claimed by acquire(); don't cancel it
+    m_hoverIntentTimer->stop();
+    m_hoverVideoId.clear();
+    m_prefetchedVideoId.clear();
+    m_indexTitles.insert(videoId, title);
+    recordWatch(videoId);
+
+    auto *tw = new TranscriptWindow(videoId, title, startSeconds, m_playerPool, m_service, this);
+    connect(tw, &TranscriptWindow::currentVideoChanged, this, [this, tw](const QString &newVideoId, const QString &newTitle) {
+        recordWatch(newVideoId);
+        int tabIndex = m_tabs->indexOf(tw);
+        if (tabIndex >= 0) {
+            m_tabs->setTabText(tabIndex, newTitle.left(15) + "...");
+        }
+    });
+    m_memoryBudget->track(tw);
     int index = m_tabs->addTab(tw, title.left(15) + "...");
     m_tabs->setCurrentIndex(index);
 }
 
+void MainWindow::setupRecommendationsTab() {
+    m_recommendationsTab = new QWidget();
+    m_recommendationsTab->setObjectName("centralWidget");
+
+    QVBoxLayout *layout = new QVBoxLayout(m_recommendationsTab);
+    layout->setContentsMargins(32, 28, 32, 28);
+    layout->setSpacing(16);
+
+    QLabel *headerLabel = new QLabel("Recommended for You", this);
+    headerLabel->setStyleSheet("font-size: 22px; font-weight: 700; color: #cdd6f4; margin-bottom: 8px;");
+    layout->addWidget(headerLabel);
+
+    m_recommendationsSummary = new QLabel(this);
+    m_recommendationsSummary->setStyleSheet("font-size: 13px; color: #a6adc8;");
+    layout->addWidget(m_recommendationsSummary);
+
+    m_recommendationsList = new QListWidget(this);
+    m_recommendationsList->setViewMode(QListWidget::IconMode);
+    m_recommendationsList->setResizeMode(QListWidget::Adjust);
+    m_recommendationsList->setMovement(QListView::Static);
+    m_recommendationsList->setSpacing(16);
+    m_recommendationsList->setUniformItemSizes(true);
+    m_recommendationsList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_recommendationsList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_recommendationsList->setFrameShape(QFrame::NoFrame);
+    m_recommendationsList->setSelectionMode(QAbstractItemView::NoSelection);
+    m_recommendationsList->setStyleSheet(m_feedList->styleSheet());
+    m_recommendationsList->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_recommendationsList, &QListWidget::itemClicked, this, &MainWindow::openVideoFromItem);
+    connect(m_recommendationsList, &QListWidget::customContextMenuRequested, this, &MainWindow::showContextMenu);
+    layout->addWidget(m_recommendationsList, 1);
+}
+
+void MainWindow::recordWatch(const QString &videoId) {
+    const VideoResult *vid = m_videoIndex.find(videoId);
+    m_service->recordWatch(videoId, vid ? vid->channelId : QString());
+}
+
+void MainWindow::setupTranscriptsTab() {
+    m_indexThreads.setMaxThreadCount(1);
+    m_transcriptIndex = new TranscriptIndex(
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/transcript-index");
+
+    m_transcriptsTab = new QWidget();
+    m_transcriptsTab->setObjectName("centralWidget");
+
+    QVBoxLayout *layout = new QVBoxLayout(m_transcriptsTab);
+    layout->setContentsMargins(32, 28, 32, 28);
+    layout->setSpacing(16);
+
+    QLabel *headerLabel = new QLabel("Search Transcripts", this);
+    headerLabel->setStyleSheet("font-size: 22px; font-weight: 700; color: #cdd6f4; margin-bottom: 8px;");
+    layout->addWidget(headerLabel);
+
+    m_transcriptQuery = new QLineEdit(this);
+    m_transcriptQuery->setObjectName("searchInput");
+    m_transcriptQuery->setPlaceholderText("Find words spoken in videos you've watched or queued...");
+    m_transcriptQuery->setMinimumHeight(52);
+    m_transcriptQuery->setClearButtonEnabled(true);
+    layout->addWidget(m_transcriptQuery);
+
+    m_transcriptSummary = new QLabel(this);
+    m_transcriptSummary->setStyleSheet("font-size: 13px; color: #a6adc8;");
+    layout->addWidget(m_transcriptSummary);
+
+    m_transcriptHits = new QListWidget(this);
+    m_transcriptHits->setSpacing(4);
+    m_transcriptHits->setFrameShape(QFrame::NoFrame);
+    m_transcriptHits->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    layout->addWidget(m_transcriptHits, 1);
+
+    // Lookups are a few binary searches over mapped postings, cheap enough to run per keystroke
+    connect(m_transcriptQuery, &QLineEdit::textChanged, this, &MainWindow::searchTranscripts);
+    connect(m_transcriptHits, &QListWidget::itemClicked, this, &MainWindow::openTranscriptHit);
+    searchTranscripts(QString());
+}
+
+void MainWindow::indexTranscript(const QString &videoId, const Transcript &transcript) {
+    if (m_transcriptIndex->contains(videoId)) return;
+
+    TranscriptIndex *index = m_transcriptIndex;
+    QString title = m_indexTitles.value(videoId, videoId);
+    (void)QtConcurrent::run(&m_indexThreads, [index, videoId, title, transcript]() {
+        index->add(videoId, title, transcript);
+    });
+}
+
+void MainWindow::searchTranscripts(const QString &query) {
+    m_transcriptHits->clear();
+    if (query.trimmed().isEmpty()) {
+        m_transcriptSummary->setText(QString("%1 transcripts indexed").arg(m_transcriptIndex->documentCount()));
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<TranscriptIndex::Hit> hits = m_transcriptIndex->search(query);
+    qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+    for (const auto &hit : hits) {
+        for (qint32 startMs : hit.timesMs) {
+            QListWidgetItem *item = new QListWidgetItem(
+                QString("%1   %2").arg(Transcript::formatTimestamp(startMs), hit.title));
+            item->setData(Qt::UserRole, hit.videoId);
+            item->setData(Qt::UserRole + 1, hit.title);
+            item->setData(Qt::UserRole + 4, startMs);
+            m_transcriptHits->addItem(item);
+        }
+    }
+    m_transcriptSummary->setText(QString("%1 videos (%2 ms)").arg(hits.size()).arg(elapsedUs / 1000.0, 0, 'f', 2));
+}
+
+void MainWindow::openTranscriptHit(QListWidgetItem *item) {
+    openVideoById(item->data(Qt::UserRole).toString(), item->data(Qt::UserRole + 1).toString(),
+                  item->data(Qt::UserRole + 4).toInt() / 1000.0);
+}
+
+TranscriptWindow *MainWindow::queueTarget() const {
+    if (auto *current = qobject_cast<TranscriptWindow *>(m_tabs->currentWidget())) {
+        return current;
+    }
+    for (int i = m_tabs->count() - 1; i >= 0; --i) {
+        if (auto *tw = qobject_cast<TranscriptWindow *>(m_tabs->widget(i))) {
+            return tw;
+        }
+    }
+    return nullptr;
+}
+
+void MainWindow::queueVideo(const QString &videoId, const QString &title) {
+    if (videoId.isEmpty()) return;
+
+    // Queue into the active (or last opened) player; with none open, just start playing
+    TranscriptWindow *target = queueTarget();
+    if (!target) {
+        openVideoById(videoId, title);
+        return;
+    }
+    target->enqueue(videoId, title);
+
+    // Queued videos are searchable before they play
+    m_indexTitles.insert(videoId, title);
+    m_service->fetchTranscript(videoId);
+}
+
+void MainWindow::setupHoverPrefetch(QListWidget *list) {
+    list->setMouseTracking(true);
+    list->viewport()->installEventFilter(this);
+
+    connect(list, &QListWidget::itemEntered, this, &MainWindow::trackHoverIntent);
+    connect(list, &QListWidget::currentItemChanged, this, [this](QListWidgetItem *current) {
+        if (current) trackHoverIntent(current);
+    });
+}
+
+void MainWindow::trackHoverIntent(QListWidgetItem *item) {
+    QString videoId = item->data(Qt::UserRole).toString();
+    if (videoId == m_hoverVideoId) return;
+
+    // Pointer moved on: drop the previous speculative load before arming the next
+    cancelHoverIntent();
+    m_hoverVideoId = videoId;
+    if (!videoId.isEmpty()) {
+        m_hoverIntentTimer->start();
+    }
+}
+
+void MainWindow::cancelHoverIntent() {
+    m_hoverIntentTimer->stop();
+    m_hoverVideoId.clear();
+    if (!m_prefetchedVideoId.isEmpty()) {
+        m_prefetchedVideoId.clear();
+        m_playerPool->cancelPrefetch();
+    }
+}
+
+void MainWindow::onHoverIntent() {
+    if (m_hoverVideoId.isEmpty()) return;
+
+    m_prefetchedVideoId = m_hoverVideoId;
+    m_playerPool->prefetch(m_prefetchedVideoId);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() == QEvent::Leave &&
+        (watched == m_videoList->viewport() || watched == m_feedList->viewport() ||
+         watched == m_recommendationsList->viewport())) {
+        cancelHoverIntent();
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::prewarmPlayer() {
+    m_playerPool->prewarm();
+}
+
 void MainWindow::performSearch() {
     QString query = m_searchInput->text().trimmed();
     if (query.isEmpty()) return;
-    
-    m_searchBtn->setText("Searching...");
-    m_searchBtn->setEnabled(false);
-    m_videoList->clear();
+
+    m_searchDebounce->stop();
+    m_searchCompleter->popup()->hide();
+    m_service->recordSearch(query);
+    showLocalResults(query, true);
+    m_requestedSearchKey = YouTubeService::searchKey(query);
+    m_requestedSearchCommitted = true;
     m_service->searchVideos(query);
 }
 
+void MainWindow::onSearchEdited(const QString &text) {
+    QStringList suggestions = m_service->searchSuggestions(text);
+    m_suggestionModel->setStringList(suggestions);
+    if (suggestions.isEmpty() || text.trimmed().isEmpty()) {
+        m_searchCompleter->popup()->hide();
+    } else {
+        m_searchCompleter->complete();
+    }
+
+    bool searchingRemote = text.trimmed().size() >= TYPEAHEAD_MIN_CHARS;
+    if (searchingRemote) {
+        m_searchDebounce->start();
+    } else {
+        m_searchDebounce->stop();
+        m_service->cancelSearch();
+    }
+    showLocalResults(text, searchingRemote);
+}
+
+void MainWindow::runTypeaheadSearch() {
+    m_requestedSearchKey = YouTubeService::searchKey(m_searchInput->text());
+    m_requestedSearchCommitted = false;
+    m_service->searchVideos(m_searchInput->text(), false);
+}
+
+void MainWindow::showLocalResults(const QString &query, bool searchingRemote) {
+    static Metrics::Histogram &queryUs = Metrics::histogram("local_index.query_us");
+
+    QString key = YouTubeService::searchKey(query);
+    if (key.isEmpty()) {
+        setSearchStatus(QString());
+        return;
+    }
+    // The service won't search the same key again, so the remote results must stay up, and
+    // nothing will arrive to clear a "searching" status left by an intermediate prefix
+    if (key == m_remoteResultsKey) {
+        setSearchStatus(QString());
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<VideoResult> hits = m_videoIndex.search(query, LOCAL_RESULT_LIMIT);
+    queryUs.record(timer.nsecsElapsed() / 1000);
+
+    // Stale local hits for an earlier prefix would look like matches; remote ones can stay
+    if (!hits.isEmpty() || m_showingLocalResults) {
+        // The service still considers the replaced query current: it would neither search it
+        // again nor stop paging it
+        if (!m_remoteResultsKey.isEmpty()) {
+            m_service->cancelSearch();
+            m_remoteResultsKey.clear();
+        }
+        populateVideoList(m_videoList, hits);
+        m_videoList->scrollToTop();
+        m_showingLocalResults = true;
+    }
+    m_localResultCount = hits.size();
+
+    QString status = QString("%1 videos you've seen").arg(hits.size());
+    if (searchingRemote) status += QStringLiteral("  \u00b7  searching YouTube...");
+    setSearchStatus(status);
+}
+
+void MainWindow::setSearchStatus(const QString &text) {
+    m_searchStatus->setText(text);
+    m_searchStatus->setVisible(!text.isEmpty());
+}
+
 void MainWindow::handleSearchResults(const QList<VideoResult> &results) {
-    m_searchBtn->setText("Search");
-    m_searchBtn->setEnabled(true);
+    m_showingLocalResults = false;
+    m_remoteResultsKey = m_requestedSearchKey;
+    setSearchStatus(QString());
     populateVideoList(m_videoList, results);
+    m_videoList->scrollToTop();
+    indexVideos(results);
+}
+
+void MainWindow::appendSearchResults(const QList<VideoResult> &results) {
+    appendVideoCards(m_videoList, results);
+    indexVideos(results);
+}
+
+void MainWindow::onSearchFailed(const QString &msg) {
+    // Offline (or out of quota): the local hits are the answer
+    if (m_showingLocalResults && m_localResultCount > 0) {
+        setSearchStatus(QStringLiteral("%1 videos you've seen  \u00b7  YouTube search failed: %2")
+                            .arg(m_localResultCount).arg(msg));
+        return;
+    }
+    // A dialog on every pause in typing would fight the user for focus; only Enter gets one
+    if (!m_requestedSearchCommitted) {
+        setSearchStatus("YouTube search failed: " + msg);
+        return;
+    }
+    showError(msg);
+}
+
+void MainWindow::indexVideos(const QList<VideoResult> &videos) {
+    if (videos.isEmpty()) return;
+
+    m_videoIndex.addAll(videos, QDateTime::currentSecsSinceEpoch());
+    Metrics::gauge("local_index.videos").set(m_videoIndex.size());
+    // Saving before the file is read would drop everything in it
+    if (m_videoIndexLoaded) m_videoIndexSaveTimer->start();
+}
+
+void MainWindow::saveVideoIndex() {
+    m_videoIndexSaveTimer->stop();
+    if (!m_videoIndexLoaded) return;
+    (void)QtConcurrent::run(&m_indexThreads, &VideoIndex::save, videoIndexPath(), m_videoIndex.documents());
+}
+
+QString MainWindow::videoIndexPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/video-index.dat";
+}
+
+void MainWindow::maybeLoadMoreResults() {
+    // Pages belong to a remote query; never append them under local hits
+    if (m_showingLocalResults) return;
+    QScrollBar *bar = m_videoList->verticalScrollBar();
+    if (bar->maximum() - bar->value() > LOAD_MORE_MARGIN_PX) return;
+    if (m_loadMoreQueued || !m_service->hasMoreSearchResults()) return;
+
+    // Out of the scroll/layout callback: appending re-enters rangeChanged
+    m_loadMoreQueued = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_loadMoreQueued = false;
+        m_service->fetchMoreSearchResults();
+    });
 }
 
 void MainWindow::fetchThumbnail(const QString &url, QListWidgetItem *item) {
-    QNetworkAccessManager *net = new QNetworkAccessManager(this);
-    QNetworkReply *reply = net->get(QNetworkRequest(QUrl(url)));
-    connect(reply, &QNetworkReply::finished, [reply, item, net]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QPixmap pixmap;
-            pixmap.loadFromData(reply->readAll());
-            item->setIcon(QIcon(pixmap));
-        }
-        reply->deleteLater();
-        net->deleteLater();
+    QListWidget *list = item->listWidget();
+    loadThumbnail(url, list, [item](const QPixmap &pixmap) {
+        item->setIcon(QIcon(pixmap));
     });
 }
 
+void MainWindow::clearPlayerData() {
+    PlayerView::clearPlayerData();
+    QMessageBox::information(this, "Player Data Cleared",
+        "Player cookies, cache and history have been cleared.");
+}
+
+void MainWindow::showDiagnostics() {
+    if (!m_diagnosticsView) {
+        m_diagnosticsView = new DiagnosticsView(this);
+        m_diagnosticsView->setPlayerMemoryBudget(m_memoryBudget);
+    }
+    int index = m_tabs->indexOf(m_diagnosticsView);
+    if (index < 0) index = m_tabs->addTab(m_diagnosticsView, "Diagnostics");
+    m_tabs->setCurrentIndex(index);
+}
+
 void MainWindow::showError(const QString &msg) {
     m_searchBtn->setText("Search");
     m_searchBtn->setEnabled(true);
@@ -8,38 +8,111 @@
 #include <QTabWidget>
 #include <QMenu>
 #include <QStackedWidget>
+#include <QTimer>
+#include <QThreadPool>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QPixmap>
+#include <functional>
 #include "../backend/YouTubeService.h"
 #include "../backend/GoogleAuth.h"
+#include "../backend/VideoIndex.h"
+
+class PlayerViewPool;
+class TranscriptWindow;
+class PlayerMemoryBudget;
+class TranscriptIndex;
+class DiagnosticsView;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    MainWindow(GoogleAuth *auth, YouTubeService *service, QWidget *parent = nullptr);
+    ~MainWindow();
+
+    // Cached cards shown until the live feed arrives; ignored once it has
+    void showFeedSnapshot(const QList<VideoResult> &results);
+
+    // First WebEngine use; call once the UI is idle so the first video opens instantly
+    void prewarmPlayer();
+
+signals:
+    void feedShown(int count, bool fromSnapshot);
 
 private slots:
     void performSearch();
+    void onSearchEdited(const QString &text);
+    void runTypeaheadSearch();
     void handleSearchResults(const QList<VideoResult> &results);
+    void appendSearchResults(const QList<VideoResult> &results);
+    void onSearchFailed(const QString &msg);
+    void maybeLoadMoreResults();
     void handleSubscriptionFeed(const QList<VideoResult> &results);
     void handleRecommendations(const QList<VideoResult> &results);
     void openVideoFromItem(QListWidgetItem *item);
-    void openVideoById(const QString &videoId, const QString &title);
+    void openVideoById(const QString &videoId, const QString &title, double startSeconds = 0);
+    void queueVideo(const QString &videoId, const QString &title);
     void showContextMenu(const QPoint &pos);
     void showError(const QString &msg);
+    void clearPlayerData();
+    void showDiagnostics();
+    void onHoverIntent();
+    void applyVideoStatistics(const QList<VideoResult> &videos);
+    void indexTranscript(const QString &videoId, const Transcript &transcript);
+    void searchTranscripts(const QString &query);
+    void openTranscriptHit(QListWidgetItem *item);
     
     void onSignInClicked();
     void onAuthenticated();
     void onAuthFailed(const QString &error);
     void onLoggedOut();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
     void setupHomeTab();
+    void setupTranscriptsTab();
+    void setupRecommendationsTab();
+    void setupHoverPrefetch(QListWidget *list);
+    void trackHoverIntent(QListWidgetItem *item);
+    void cancelHoverIntent();
     void updateAuthUI();
+    void showLocalResults(const QString &query, bool searchingRemote);
+    void setSearchStatus(const QString &text);
+    void indexVideos(const QList<VideoResult> &videos);
+    void saveVideoIndex();
+    void recordWatch(const QString &videoId);
+    static QString videoIndexPath();
     void populateVideoList(QListWidget *list, const QList<VideoResult> &results);
+    void appendVideoCards(QListWidget *list, const QList<VideoResult> &results);
     void fetchThumbnail(const QString &url, QListWidgetItem *item);
+    // Decoded thumbnails come from memory, then the HTTP disk cache, then the network;
+    // apply runs only if target is still alive
+    void loadThumbnail(const QString &url, QObject *target, std::function<void(const QPixmap &)> apply);
+    TranscriptWindow *queueTarget() const;
     
     YouTubeService *m_service;
     GoogleAuth *m_auth;
+    PlayerViewPool *m_playerPool;
+    PlayerMemoryBudget *m_memoryBudget;
+    QAction *m_clearPlayerDataAction;
+
+    // One connection pool for all thumbnails, backed by an HTTP disk cache
+    QNetworkAccessManager *m_thumbnailNet;
+    // Cost in KB
+    QCache<QString, QPixmap> m_thumbnailCache;
+    static const int THUMBNAIL_MEMORY_KB = 64 * 1024;
+    static const int THUMBNAIL_DISK_CACHE_MB = 100;
+
+    // Hover/selection intent on video cards prefetches the embed into the pool
+    QTimer *m_hoverIntentTimer;
+    QString m_hoverVideoId;
+    QString m_prefetchedVideoId;
+    static const int HOVER_INTENT_MS = 150;
     
     QTabWidget *m_tabs;
     
@@ -52,10 +125,57 @@ private:
     QPushButton *m_signOutBtn;
     QLabel *m_authStatusLabel;
     QListWidget *m_feedList;
+    bool m_liveFeedShown = false;
+    bool m_snapshotShown = false;
     
     // Search tab
     QWidget *m_searchTab;
     QLineEdit *m_searchInput;
     QListWidget *m_videoList;
     QPushButton *m_searchBtn;
+    QTimer *m_searchDebounce;
+    QCompleter *m_searchCompleter;
+    QStringListModel *m_suggestionModel;
+    QLabel *m_searchStatus;
+    static const int SEARCH_DEBOUNCE_MS = 400;
+    // Every search call costs 100 quota units; don't spend them on one or two letters
+    static const int TYPEAHEAD_MIN_CHARS = 3;
+    // Ask for the next page this far (in pixels) before the bottom of the results
+    static const int LOAD_MORE_MARGIN_PX = 600;
+    bool m_loadMoreQueued = false;
+
+    // Local hits over every video shown so far fill the list per keystroke, until the remote
+    // results for the query arrive or instead of them when the search fails
+    VideoIndex m_videoIndex;
+    QFutureWatcher<VideoIndex> m_videoIndexLoad;
+    bool m_videoIndexLoaded = false;
+    QTimer *m_videoIndexSaveTimer;
+    bool m_showingLocalResults = false;
+    int m_localResultCount = 0;
+    // Search key of the remote query last asked for, and of the one whose results are shown
+    QString m_requestedSearchKey;
+    QString m_remoteResultsKey;
+    // Enter/Search button rather than typeahead; only those report failures in a dialog
+    bool m_requestedSearchCommitted = false;
+    static const int LOCAL_RESULT_LIMIT = 12;
+    static const int VIDEO_INDEX_SAVE_DELAY_MS = 5000;
+
+    // For You tab: ranked by the service from videos already fetched, refreshed whenever shown
+    QWidget *m_recommendationsTab = nullptr;
+    QLabel *m_recommendationsSummary;
+    QListWidget *m_recommendationsList;
+    QStringList m_recommendationIds;
+
+    // Transcripts tab: full-text search over every transcript fetched so far
+    QWidget *m_transcriptsTab;
+    QLineEdit *m_transcriptQuery;
+    QLabel *m_transcriptSummary;
+    QListWidget *m_transcriptHits;
+    TranscriptIndex *m_transcriptIndex;
+    // Single worker so index appends stay ordered and off the UI thread
+    QThreadPool m_indexThreads;
+    QHash<QString, QString> m_indexTitles;
+
+    // Opened on demand; closing the tab only hides it
+    DiagnosticsView *m_diagnosticsView = nullptr;
 };
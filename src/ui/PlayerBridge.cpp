@@ -0,0 +1,73 @@
+#include "PlayerBridge.h"
+
+const int PlayerBridge::COMMAND_INTERVAL_MS = 50;
+
+PlayerBridge::PlayerBridge(QObject *parent)
+    : QObject(parent)
+    , m_rateTimer(new QTimer(this))
+{
+    m_rateTimer->setSingleShot(true);
+    m_rateTimer->setInterval(COMMAND_INTERVAL_MS);
+    connect(m_rateTimer, &QTimer::timeout, this, &PlayerBridge::flushRate);
+}
+
+void PlayerBridge::setRate(double rate) {
+    m_requestedRate = rate;
+
+    // Leading edge goes out immediately, the rest of a drag collapses into the trailing edge
+    if (!m_rateTimer->isActive()) {
+        flushRate();
+    }
+}
+
+void PlayerBridge::flushRate() {
+    if (m_requestedRate == m_sentRate) return;
+
+    m_sentRate = m_requestedRate;
+    emit command("rate", m_sentRate);
+    m_rateTimer->start();
+}
+
+void PlayerBridge::resendRate() {
+    m_sentRate = m_requestedRate;
+    emit command("rate", m_sentRate);
+}
+
+void PlayerBridge::setSchedule(const QVariantList &schedule) {
+    if (schedule.isEmpty() && m_schedule.isEmpty()) return;
+
+    m_schedule = schedule;
+    emit command("schedule", m_schedule);
+}
+
+void PlayerBridge::resendSchedule() {
+    emit command("schedule", m_schedule);
+}
+
+void PlayerBridge::seek(double seconds) {
+    emit command("seek", seconds);
+}
+
+void PlayerBridge::play() {
+    emit command("play", QVariant());
+}
+
+void PlayerBridge::pause() {
+    emit command("pause", QVariant());
+}
+
+void PlayerBridge::reportReady(const QString &videoId) {
+    emit ready(videoId);
+}
+
+void PlayerBridge::reportState(double position, double rate, double buffered, double duration, bool paused) {
+    emit stateChanged(position, rate, buffered, duration, paused);
+}
+
+void PlayerBridge::reportFirstFrame(double ttffMs, double networkBytes, double cachedBytes) {
+    emit firstFrame(static_cast<qint64>(ttffMs), static_cast<qint64>(networkBytes), static_cast<qint64>(cachedBytes));
+}
+
+void PlayerBridge::reportEnded() {
+    emit ended();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVariant>
+#include <QTimer>
+
+// QObject published to the player shell over QWebChannel. Commands go out
+// through command(); the shell relays them to the script injected into the
+// embed frame, which owns the <video> element and pushes state back through
+// the report*() slots.
+class PlayerBridge : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PlayerBridge(QObject *parent = nullptr);
+
+    // Coalesced: slider drags send at most one rate per COMMAND_INTERVAL_MS, latest value wins
+    void setRate(double rate);
+    void seek(double seconds);
+    void play();
+    void pause();
+    // A new embed document starts at 1x; send the wanted rate again
+    void resendRate();
+
+    // Flat [startMs, multiplier, ...] timeline applied on top of the rate inside the embed; empty clears it
+    void setSchedule(const QVariantList &schedule);
+    void resendSchedule();
+    bool hasSchedule() const { return !m_schedule.isEmpty(); }
+
+    double requestedRate() const { return m_requestedRate; }
+
+signals:
+    // Consumed by the shell page
+    void command(const QString &name, const QVariant &value);
+
+    void ready(const QString &videoId);
+    void stateChanged(double position, double rate, double buffered, double duration, bool paused);
+    void firstFrame(qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes);
+    void ended();
+
+public slots:
+    // Called from JavaScript
+    void reportReady(const QString &videoId);
+    void reportState(double position, double rate, double buffered, double duration, bool paused);
+    void reportFirstFrame(double ttffMs, double networkBytes, double cachedBytes);
+    void reportEnded();
+
+private slots:
+    void flushRate();
+
+private:
+    QTimer *m_rateTimer;
+    double m_requestedRate = 1.0;
+    double m_sentRate = 1.0;
+    QVariantList m_schedule;
+
+    static const int COMMAND_INTERVAL_MS;
+};
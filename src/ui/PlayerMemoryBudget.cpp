@@ -0,0 +1,124 @@
+#include "PlayerMemoryBudget.h"
+#include "../backend/Log.h"
+#include "TranscriptWindow.h"
+#include "../backend/ProcessMemory.h"
+#include <QHash>
+#include <QSettings>
+
+const int PlayerMemoryBudget::SAMPLE_INTERVAL_MS = 5000;
+
+PlayerMemoryBudget::PlayerMemoryBudget(QObject *parent)
+    : QObject(parent)
+    , m_sampleTimer(new QTimer(this))
+{
+    QSettings settings("YouCpp", "YouCpp");
+    m_budgetBytes = settings.value("player/memoryBudgetMB", 1536).toLongLong() * 1024 * 1024;
+
+    m_sampleTimer->setInterval(SAMPLE_INTERVAL_MS);
+    connect(m_sampleTimer, &QTimer::timeout, this, &PlayerMemoryBudget::sample);
+}
+
+QByteArray PlayerMemoryBudget::processModelFlags() {
+    QSettings settings("YouCpp", "YouCpp");
+    QString processModel = settings.value("player/processModel", "process-per-site").toString();
+    int rendererLimit = settings.value("player/rendererProcessLimit", 4).toInt();
+
+    // Every player tab is the same site, so process-per-site lets them share renderers
+    QByteArray flags;
+    if (processModel == "process-per-site" || processModel == "single-process") {
+        flags += "--" + processModel.toUtf8() + " ";
+    }
+    if (rendererLimit > 0) {
+        flags += "--renderer-process-limit=" + QByteArray::number(rendererLimit) + " ";
+    }
+    return flags;
+}
+
+void PlayerMemoryBudget::track(TranscriptWindow *tab) {
+    m_tabs.append(tab);
+    if (!m_sampleTimer->isActive()) {
+        m_sampleTimer->start();
+    }
+}
+
+void PlayerMemoryBudget::touch(TranscriptWindow *tab) {
+    for (int i = 0; i < m_tabs.size(); ++i) {
+        if (m_tabs[i] == tab) {
+            m_tabs.move(i, m_tabs.size() - 1);
+            return;
+        }
+    }
+}
+
+void PlayerMemoryBudget::sample() {
+    m_tabs.removeAll(nullptr);
+    if (m_tabs.isEmpty()) {
+        m_sampleTimer->stop();
+    }
+
+    QHash<qint64, int> tabsPerPid;
+    for (const auto &tab : m_tabs) {
+        qint64 pid = tab->rendererPid();
+        if (pid > 0) tabsPerPid[pid]++;
+    }
+
+    QHash<qint64, qint64> rssPerPid;
+    m_totalBytes = 0;
+    for (auto it = tabsPerPid.constBegin(); it != tabsPerPid.constEnd(); ++it) {
+        qint64 rss = ProcessMemory::residentBytes(it.key());
+        rssPerPid.insert(it.key(), rss);
+        m_totalBytes += rss;
+    }
+
+    m_usage.clear();
+    for (const auto &tab : m_tabs) {
+        TabUsage usage;
+        usage.tab = tab;
+        usage.rendererPid = tab->rendererPid();
+        if (usage.rendererPid > 0) {
+            usage.bytes = rssPerPid.value(usage.rendererPid) / tabsPerPid.value(usage.rendererPid, 1);
+        }
+        m_usage.append(usage);
+    }
+
+    emit usageSampled(m_usage, m_totalBytes);
+    enforceBudget();
+}
+
+void PlayerMemoryBudget::enforceBudget() {
+    if (m_budgetBytes <= 0 || m_totalBytes <= m_budgetBytes) return;
+
+    LOG_INFO("PlayerMemoryBudget", "Renderers use %lld MB, budget is %lld MB", (long long)(m_totalBytes / (1024 * 1024)), (long long)(m_budgetBytes / (1024 * 1024)));
+
+    // m_usage follows m_tabs, so the front is the least recently used tab
+    QList<Candidate> candidates;
+    for (const auto &usage : m_usage) {
+        Candidate candidate;
+        if (usage.tab) {
+            candidate.bytes = usage.bytes;
+            candidate.visible = usage.tab->isVisible();
+            candidate.hibernating = usage.tab->isHibernating();
+            candidate.audible = usage.tab->isAudible();
+        }
+        candidates.append(candidate);
+    }
+
+    for (int i : pickVictims(candidates, m_totalBytes, m_budgetBytes)) {
+        const TabUsage &usage = m_usage[i];
+        usage.tab->hibernate();
+        LOG_INFO("PlayerMemoryBudget", "Hibernated %s (~%lld MB)", usage.tab->videoId(), (long long)(usage.bytes / (1024 * 1024)));
+    }
+}
+
+QList<int> PlayerMemoryBudget::pickVictims(const QList<Candidate> &candidates, qint64 totalBytes, qint64 budgetBytes) {
+    QList<int> victims;
+    qint64 projected = totalBytes;
+    for (int i = 0; i < candidates.size() && projected > budgetBytes; ++i) {
+        const Candidate &c = candidates[i];
+        // A tab playing in the background is in use even though it's hidden
+        if (c.bytes == 0 || c.visible || c.hibernating || c.audible) continue;
+        victims.append(i);
+        projected -= c.bytes;
+    }
+    return victims;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+
+class TranscriptWindow;
+
+// Samples renderer memory for every player tab and hibernates the least
+// recently used background tabs when the total goes over budget.
+class PlayerMemoryBudget : public QObject {
+    Q_OBJECT
+
+public:
+    struct TabUsage {
+        QPointer<TranscriptWindow> tab;
+        qint64 rendererPid = 0;
+        // Renderer RSS split evenly between the tabs sharing that process
+        qint64 bytes = 0;
+    };
+
+    explicit PlayerMemoryBudget(QObject *parent = nullptr);
+
+    void track(TranscriptWindow *tab);
+    // Marks a tab as most recently used
+    void touch(TranscriptWindow *tab);
+
+    qint64 budgetBytes() const { return m_budgetBytes; }
+    qint64 totalBytes() const { return m_totalBytes; }
+    QList<TabUsage> usage() const { return m_usage; }
+
+    // What eviction looks at, per tab
+    struct Candidate {
+        qint64 bytes = 0;
+        bool visible = false;
+        bool hibernating = false;
+        bool audible = false;
+    };
+    // Indexes into candidates (least recently used first) to hibernate until the projected
+    // total fits the budget. Visible, audible and already hibernating tabs are never picked.
+    static QList<int> pickVictims(const QList<Candidate> &candidates, qint64 totalBytes, qint64 budgetBytes);
+
+    // Chromium flags for the process model, read from settings before QApplication exists
+    static QByteArray processModelFlags();
+
+signals:
+    void usageSampled(const QList<PlayerMemoryBudget::TabUsage> &usage, qint64 totalBytes);
+
+public slots:
+    void sample();
+
+private:
+    void enforceBudget();
+
+    // Least recently used first
+    QList<QPointer<TranscriptWindow>> m_tabs;
+    QList<TabUsage> m_usage;
+    qint64 m_totalBytes = 0;
+    qint64 m_budgetBytes;
+    QTimer *m_sampleTimer;
+
+    static const int SAMPLE_INTERVAL_MS;
+};
@@ -0,0 +1,510 @@
+#include "PlayerView.h"
+#include "../backend/Log.h"
+#include "PlayerBridge.h"
+#include "../backend/Trace.h"
+#include <QWebEngineSettings>
+#include <QWebEngineProfile>
+#include <QWebEngineCookieStore>
+#include <QWebEnginePage>
+#include <QWebEngineHistory>
+#include <QWebEngineScript>
+#include <QWebEngineScriptCollection>
+#include <QWebChannel>
+#include <QFile>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QSettings>
+#include <QApplication>
+#include <algorithm>
+#include <limits>
+
+QWebEngineProfile *PlayerView::playerProfile() {
+    static QWebEngineProfile *profile = nullptr;
+    if (profile) return profile;
+
+    QSettings settings("YouCpp", "YouCpp");
+    int cacheMegabytes = settings.value("player/cacheMegabytes", 256).toInt();
+    // Multiply in 64 bits; the profile takes an int, so 2 GB and up is clamped rather than wrapped
+    qint64 cacheBytes = std::clamp<qint64>(qint64(cacheMegabytes) * 1024 * 1024, 0, std::numeric_limits<int>::max());
+
+    // A storage name makes the profile persistent (not off-the-record)
+    profile = new QWebEngineProfile("youcpp-player", qApp);
+    profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+    profile->setHttpCacheMaximumSize(int(cacheBytes));
+    profile->setPersistentCookiesPolicy(QWebEngineProfile::NoPersistentCookies);
+    profile->setHttpUserAgent("Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36");
+
+    // Session cookies die with the process anyway; visited links do not
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, profile, [profile]() {
+        profile->cookieStore()->deleteAllCookies();
+        profile->clearAllVisitedLinks();
+    });
+
+    LOG_INFO("PlayerView", "Player profile at %s (cache %lld MB)", profile->cachePath(), (long long)(cacheBytes / (1024 * 1024)));
+    return profile;
+}
+
+void PlayerView::clearPlayerData() {
+    QWebEngineProfile *profile = playerProfile();
+    profile->cookieStore()->deleteAllCookies();
+    profile->clearHttpCache();
+    profile->clearAllVisitedLinks();
+}
+
+PlayerView::PlayerView(QWidget *parent)
+    : QWebEngineView(parent)
+    , m_bridge(new PlayerBridge(this))
+{
+    setPage(new QWebEnginePage(playerProfile(), this));
+    settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
+    settings()->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
+
+    QWebChannel *channel = new QWebChannel(page());
+    channel->registerObject("bridge", m_bridge);
+    page()->setWebChannel(channel, QWebEngineScript::MainWorld);
+
+    QWebEngineScript channelScript;
+    channelScript.setName("youcpp-qwebchannel");
+    channelScript.setSourceCode(webChannelScript());
+    channelScript.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    channelScript.setWorldId(QWebEngineScript::MainWorld);
+    channelScript.setRunsOnSubFrames(false);
+    page()->scripts().insert(channelScript);
+
+    // Runs inside the cross-origin embed frame, where the <video> element actually lives
+    QWebEngineScript controlScript;
+    controlScript.setName("youcpp-embed-control");
+    controlScript.setSourceCode(embedControlScript());
+    controlScript.setInjectionPoint(QWebEngineScript::DocumentReady);
+    controlScript.setWorldId(QWebEngineScript::ApplicationWorld);
+    controlScript.setRunsOnSubFrames(true);
+    page()->scripts().insert(controlScript);
+
+    connect(this, &QWebEngineView::loadFinished, this, &PlayerView::onLoadFinished);
+    connect(m_bridge, &PlayerBridge::ready, this, &PlayerView::onBridgeReady);
+    connect(m_bridge, &PlayerBridge::stateChanged, this, &PlayerView::onBridgeState);
+    connect(m_bridge, &PlayerBridge::firstFrame, this, &PlayerView::onBridgeFirstFrame);
+    connect(m_bridge, &PlayerBridge::ended, this, &PlayerView::videoEnded);
+}
+
+bool PlayerView::isValidVideoId(const QString &videoId) {
+    static const QRegularExpression idRegex("^[A-Za-z0-9_-]{1,64}$");
+    return idRegex.match(videoId).hasMatch();
+}
+
+QString PlayerView::webChannelScript() {
+    QFile file(":/qtwebchannel/qwebchannel.js");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+QString PlayerView::shellHtml() {
+    return QString(
+        "<!DOCTYPE html>"
+        "<html style='height:100%;width:100%;margin:0;padding:0;'>"
+        "<head>"
+            "<meta name='referrer' content='origin' />"
+            "<link rel='preconnect' href='https://www.youtube-nocookie.com' />"
+            "<link rel='preconnect' href='https://i.ytimg.com' />"
+            "<link rel='preconnect' href='https://www.google.com' />"
+            "<style>"
+                "html, body { height:100%; width:100%; margin:0; padding:0; overflow:hidden; background:#000; }"
+                "iframe { position:absolute; top:0; left:0; width:100%; height:100%; border:none; }"
+            "</style>"
+            "<script>"
+                "var EMBED_ORIGIN = 'https://www.youtube-nocookie.com';"
+                "var bridge = null;"
+                "var readyBeforeBridge = null;"
+                "function player() { return document.getElementById('player'); }"
+                "new QWebChannel(qt.webChannelTransport, function(channel) {"
+                    "bridge = channel.objects.bridge;"
+                    "bridge.command.connect(function(name, value) {"
+                        "var f = player();"
+                        "if (f && f.contentWindow) f.contentWindow.postMessage({ youcpp: name, value: value }, EMBED_ORIGIN);"
+                    "});"
+                    "if (readyBeforeBridge) { bridge.reportReady(readyBeforeBridge); readyBeforeBridge = null; }"
+                "});"
+                "window.addEventListener('message', function(e) {"
+                    "var f = player();"
+                    "if (!bridge || !f || e.source !== f.contentWindow || !e.data || !e.data.youcpp) return;"
+                    "var d = e.data;"
+                    "if (d.youcpp === 'state') bridge.reportState(d.position, d.rate, d.buffered, d.duration, d.paused);"
+                    "else if (d.youcpp === 'firstframe') bridge.reportFirstFrame(d.ttff, d.network, d.cached);"
+                    "else if (d.youcpp === 'ended') bridge.reportEnded();"
+                "});"
+                "function createFrame(id, start, autoplay) {"
+                    "var f = document.createElement('iframe');"
+                    "f.allow = 'autoplay; encrypted-media';"
+                    "f.allowFullscreen = true;"
+                    "f.referrerPolicy = 'origin';"
+                    "f.dataset.videoId = id;"
+                    "f.src = EMBED_ORIGIN + '/embed/' + id +"
+                        "'?autoplay=' + (autoplay ? 1 : 0) + '&enablejsapi=1&origin=' + EMBED_ORIGIN + '&rel=0' +"
+                        "(start > 0 ? '&start=' + Math.floor(start) : '');"
+                    "return f;"
+                "}"
+                "function reportReady(f) {"
+                    "if (bridge) bridge.reportReady(f.dataset.videoId);"
+                    "else readyBeforeBridge = f.dataset.videoId;"
+                "}"
+                "function promote(f) {"
+                    "var old = player();"
+                    "if (old && old !== f) old.remove();"
+                    "f.id = 'player';"
+                    "f.style.visibility = '';"
+                "}"
+                "function youcppLoad(id, start) {"
+                    "var f = createFrame(id, start, true);"
+                    "f.onload = function() { reportReady(f); };"
+                    "promote(f);"
+                    "document.body.appendChild(f);"
+                "}"
+                // Next queued video: loaded hidden and paused so advancing is just a swap
+                "function youcppPreload(id) {"
+                    "var p = document.getElementById('preload');"
+                    "if (p && p.dataset.videoId === id) return;"
+                    "if (p) p.remove();"
+                    "p = createFrame(id, 0, false);"
+                    "p.id = 'preload';"
+                    "p.style.visibility = 'hidden';"
+                    "p.onload = function() { p.dataset.loaded = '1'; };"
+                    "document.body.appendChild(p);"
+                "}"
+                "function youcppCancelPreload() {"
+                    "var p = document.getElementById('preload');"
+                    "if (p) p.remove();"
+                "}"
+                "function youcppAdvance(id) {"
+                    "var p = document.getElementById('preload');"
+                    "if (!p || p.dataset.videoId !== id) { youcppLoad(id, 0); return; }"
+                    "var start = function() {"
+                        "p.contentWindow.postMessage(JSON.stringify({ event: 'command', func: 'playVideo', args: [] }), EMBED_ORIGIN);"
+                        "reportReady(p);"
+                    "};"
+                    "promote(p);"
+                    "if (p.dataset.loaded) start();"
+                    "else p.onload = start;"
+                "}"
+                "function youcppUnload() {"
+                    "['player', 'preload'].forEach(function(id) {"
+                        "var f = document.getElementById(id);"
+                        "if (f) f.remove();"
+                    "});"
+                "}"
+            "</script>"
+        "</head>"
+        "<body></body>"
+        "</html>"
+    );
+}
+
+// The IFrame Player API clamps playbackRate to the rates YouTube offers (2x
+// at most), so this script talks to the <video> element directly.
+QString PlayerView::embedControlScript() {
+    return QString(
+        "(function() {"
+            "if (window.top === window || location.pathname.indexOf('/embed/') !== 0) return;"
+            "var PARENT_ORIGIN = 'https://www.youtube-nocookie.com';"
+            "var video = null;"
+            "var wantedRate = 0;"
+            // Adaptive speed: flat [startMs, multiplier, ...] steps on top of wantedRate
+            "var schedule = [];"
+            "var lastReport = 0;"
+            "var firstFrameSent = false;"
+            "function post(msg) { window.parent.postMessage(msg, PARENT_ORIGIN); }"
+            "function bufferedUntil(v) {"
+                "for (var i = 0; i < v.buffered.length; i++) {"
+                    "if (v.buffered.start(i) <= v.currentTime && v.currentTime <= v.buffered.end(i)) return v.buffered.end(i);"
+                "}"
+                "return v.currentTime;"
+            "}"
+            "function report(v) {"
+                "post({ youcpp: 'state', position: v.currentTime, rate: v.playbackRate, buffered: bufferedUntil(v),"
+                       "duration: isFinite(v.duration) ? v.duration : 0, paused: v.paused });"
+            "}"
+            "function targetRate() {"
+                "if (!schedule.length) return wantedRate;"
+                "var base = wantedRate > 0 ? wantedRate : 1;"
+                "var ms = video ? video.currentTime * 1000 : 0, lo = 0, hi = schedule.length / 2;"
+                "while (lo < hi) { var mid = (lo + hi) >> 1; if (schedule[mid * 2] <= ms) lo = mid + 1; else hi = mid; }"
+                "var m = lo > 0 ? schedule[lo * 2 - 1] : 1;"
+                // Chromium mutes audio above 4x; only go past it if the user already did
+                "return Math.min(base * m, Math.max(base, 4));"
+            "}"
+            "function applyRate() {"
+                "var r = targetRate();"
+                "if (video && r > 0 && Math.abs(video.playbackRate - r) > 0.001) video.playbackRate = r;"
+            "}"
+            "function reportFirstFrame() {"
+                "if (firstFrameSent) return;"
+                "firstFrameSent = true;"
+                "var network = 0, cached = 0;"
+                "performance.getEntriesByType('resource').forEach(function(r) {"
+                    "if (r.transferSize > 0) network += r.transferSize;"
+                    "else if (r.decodedBodySize > 0) cached += r.decodedBodySize;"
+                "});"
+                "post({ youcpp: 'firstframe', ttff: Math.round(performance.now()), network: network, cached: cached });"
+            "}"
+            "window.addEventListener('message', function(e) {"
+                "if (e.source !== window.parent || !e.data || !e.data.youcpp) return;"
+                "var d = e.data;"
+                "if (d.youcpp === 'rate') { wantedRate = d.value; applyRate(); return; }"
+                "if (d.youcpp === 'schedule') {"
+                    "schedule = d.value || [];"
+                    "if (!schedule.length && video && wantedRate <= 0) video.playbackRate = 1;"
+                    "applyRate();"
+                    "return;"
+                "}"
+                "if (!video) return;"
+                "if (d.youcpp === 'seek') video.currentTime = d.value;"
+                "else if (d.youcpp === 'play') video.play();"
+                "else if (d.youcpp === 'pause') video.pause();"
+            "});"
+            "function attach(v) {"
+                "video = v;"
+                "applyRate();"
+                "v.addEventListener('playing', reportFirstFrame);"
+                "v.addEventListener('timeupdate', function() {"
+                    "if (schedule.length) applyRate();"
+                    "var now = Date.now();"
+                    "if (now - lastReport >= 1000) { lastReport = now; report(v); }"
+                "});"
+                // YouTube resets the rate on new sources and after ads
+                "v.addEventListener('loadedmetadata', applyRate);"
+                "v.addEventListener('ratechange', function() {"
+                    "var r = targetRate();"
+                    "if (r > 0 && Math.abs(v.playbackRate - r) > 0.001) { applyRate(); return; }"
+                    "report(v);"
+                "});"
+                "v.addEventListener('seeked', applyRate);"
+                "['play', 'pause', 'seeked'].forEach(function(e) {"
+                    "v.addEventListener(e, function() { report(v); });"
+                "});"
+                "v.addEventListener('ended', function() { report(v); post({ youcpp: 'ended' }); });"
+            "}"
+            "var existing = document.querySelector('video');"
+            "if (existing) { attach(existing); return; }"
+            "var observer = new MutationObserver(function() {"
+                "var v = document.querySelector('video');"
+                "if (v) { observer.disconnect(); attach(v); }"
+            "});"
+            "observer.observe(document.documentElement, { childList: true, subtree: true });"
+        "})();"
+    );
+}
+
+void PlayerView::loadShell() {
+    if (m_shellReady || m_shellLoading) return;
+
+    m_shellLoading = true;
+    setHtml(shellHtml(), QUrl("https://www.youtube-nocookie.com/"));
+}
+
+void PlayerView::loadVideo(const QString &videoId, double startSeconds) {
+    if (!isValidVideoId(videoId)) return;
+
+    // Hover prefetch already has this video loaded in the hidden frame
+    if (m_shellReady && startSeconds <= 0 && videoId == m_preloadedVideoId) {
+        advanceTo(videoId);
+        return;
+    }
+
+    if (videoId != m_videoId || !m_readyClock.isValid()) {
+        m_readyClock.start();
+        m_frameClock.start();
+        Trace::endAsync("player", "player ready", m_readyTraceId);
+        m_readyTraceId = Trace::beginAsync("player", "player ready");
+    }
+    m_prefetched = false;
+    if (videoId != m_videoId) {
+        m_bridge->setSchedule({});
+    }
+    m_videoId = videoId;
+    m_position = startSeconds;
+    if (!m_shellReady) {
+        m_pendingVideoId = videoId;
+        m_pendingStart = startSeconds;
+        loadShell();
+        return;
+    }
+
+    page()->runJavaScript(QString("youcppLoad('%1', %2);").arg(videoId).arg(startSeconds));
+}
+
+void PlayerView::preloadVideo(const QString &videoId) {
+    if (!isValidVideoId(videoId) || videoId == m_preloadedVideoId) return;
+
+    m_preloadedVideoId = videoId;
+    if (!m_shellReady) {
+        loadShell();
+        return;
+    }
+    page()->runJavaScript(QString("youcppPreload('%1');").arg(videoId));
+}
+
+void PlayerView::cancelPreload() {
+    if (m_preloadedVideoId.isEmpty()) return;
+
+    m_preloadedVideoId.clear();
+    if (m_shellReady) {
+        page()->runJavaScript("youcppCancelPreload();");
+    }
+}
+
+void PlayerView::advanceTo(const QString &videoId) {
+    if (!isValidVideoId(videoId)) return;
+    if (!m_shellReady) {
+        loadVideo(videoId);
+        return;
+    }
+
+    m_readyClock.start();
+    m_frameClock.start();
+    m_prefetched = videoId == m_preloadedVideoId;
+    m_videoId = videoId;
+    m_position = 0;
+    m_bridge->setSchedule({});
+    m_preloadedVideoId.clear();
+    page()->runJavaScript(QString("youcppAdvance('%1');").arg(videoId));
+}
+
+void PlayerView::resetForReuse() {
+    m_preloadedVideoId.clear();
+    m_videoId.clear();
+    m_pendingVideoId.clear();
+    m_readyClock.invalidate();
+    m_frameClock.invalidate();
+    m_prefetched = false;
+    m_position = 0;
+    m_playbackRate = 1.0;
+    m_buffered = 0;
+    m_duration = 0;
+    m_paused = true;
+    m_bridge->setRate(1.0);
+    m_bridge->setSchedule({});
+
+    if (m_shellReady) {
+        page()->runJavaScript("youcppUnload();");
+    }
+    history()->clear();
+}
+
+void PlayerView::freeze() {
+    if (isVisible() || page()->lifecycleState() != QWebEnginePage::LifecycleState::Active) return;
+    page()->setLifecycleState(QWebEnginePage::LifecycleState::Frozen);
+}
+
+void PlayerView::discard() {
+    if (isVisible() || isDiscarded()) return;
+
+    // The shell and its iframe are gone once discarded; restore() rebuilds them
+    page()->setLifecycleState(QWebEnginePage::LifecycleState::Discarded);
+    m_preloadedVideoId.clear();
+    m_shellReady = false;
+    m_shellLoading = false;
+}
+
+void PlayerView::restore() {
+    if (isDiscarded()) {
+        QString videoId = m_videoId;
+        double position = m_position;
+
+        // Activating a discarded page reloads the shell; the video is queued behind it
+        m_restoring = true;
+        m_shellLoading = true;
+        page()->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+        if (!videoId.isEmpty()) {
+            m_videoId.clear();
+            loadVideo(videoId, position);
+        }
+    } else if (isFrozen()) {
+        page()->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+    }
+}
+
+bool PlayerView::isFrozen() const {
+    return page()->lifecycleState() == QWebEnginePage::LifecycleState::Frozen;
+}
+
+bool PlayerView::isDiscarded() const {
+    return page()->lifecycleState() == QWebEnginePage::LifecycleState::Discarded;
+}
+
+void PlayerView::setPlaybackRate(double rate) {
+    m_bridge->setRate(rate);
+}
+
+void PlayerView::seek(double seconds) {
+    m_bridge->seek(seconds);
+}
+
+void PlayerView::onBridgeReady(const QString &videoId) {
+    if (videoId != m_videoId) return;
+
+    // Fresh embed document: it has not seen any rate yet
+    if (m_bridge->requestedRate() != 1.0) {
+        m_bridge->resendRate();
+    }
+    if (m_bridge->hasSchedule()) {
+        m_bridge->resendSchedule();
+    }
+
+    if (!m_readyClock.isValid()) return;
+    qint64 elapsed = m_readyClock.elapsed();
+    m_readyClock.invalidate();
+    Trace::endAsync("player", "player ready", m_readyTraceId);
+    m_readyTraceId = 0;
+    emit playerReady(videoId, elapsed);
+}
+
+void PlayerView::onBridgeState(double position, double rate, double buffered, double duration, bool paused) {
+    m_position = position;
+    m_playbackRate = rate;
+    m_buffered = buffered;
+    m_duration = duration;
+    m_paused = paused;
+    emit stateChanged(position, rate, buffered, duration, paused);
+}
+
+void PlayerView::onBridgeFirstFrame(qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes) {
+    if (m_videoId.isEmpty()) return;
+
+    // The embed measures from its own navigation, which for a prefetched frame started
+    // long before the click; time from the load request is what the user waits for
+    if (m_frameClock.isValid()) {
+        ttffMs = m_frameClock.elapsed();
+        m_frameClock.invalidate();
+    }
+    emit firstFrame(m_videoId, ttffMs, networkBytes, cachedBytes);
+}
+
+void PlayerView::onLoadFinished(bool ok) {
+    if (!m_shellLoading) return;
+    m_shellLoading = false;
+    m_shellReady = ok;
+
+    if (!ok && m_restoring) {
+        // The automatic reload did not bring the shell back; load it ourselves
+        m_restoring = false;
+        loadShell();
+        return;
+    }
+    m_restoring = false;
+
+    if (!ok) return;
+    emit shellReady();
+
+    if (!m_preloadedVideoId.isEmpty()) {
+        page()->runJavaScript(QString("youcppPreload('%1');").arg(m_preloadedVideoId));
+    }
+
+    if (!m_pendingVideoId.isEmpty()) {
+        QString videoId = m_pendingVideoId;
+        double start = m_pendingStart;
+        m_pendingVideoId.clear();
+        m_pendingStart = 0;
+        loadVideo(videoId, start);
+    }
+}
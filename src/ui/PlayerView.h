@@ -0,0 +1,104 @@
+#pragma once
+#include <QWebEngineView>
+#include <QString>
+#include <QElapsedTimer>
+
+class QWebEngineProfile;
+class PlayerBridge;
+
+// Web view hosting the embed player inside a small shell page. The shell is
+// loaded once; later videos only swap the iframe source. Playback is driven
+// through a PlayerBridge published over QWebChannel.
+class PlayerView : public QWebEngineView {
+    Q_OBJECT
+
+public:
+    explicit PlayerView(QWidget *parent = nullptr);
+
+    void loadShell();
+    void loadVideo(const QString &videoId, double startSeconds = 0);
+    // Queue support: the next video loads hidden in the same page, advanceTo() swaps it in
+    void preloadVideo(const QString &videoId);
+    void advanceTo(const QString &videoId);
+    QString preloadedVideoId() const { return m_preloadedVideoId; }
+    void cancelPreload();
+    // True when the current video was swapped in from a preloaded frame
+    bool wasPrefetched() const { return m_prefetched; }
+    // Drops the current video but keeps the page and its renderer alive for reuse
+    void resetForReuse();
+
+    // Background lifecycle: frozen pages keep their renderer but stop running;
+    // discarded pages give the renderer up and are rebuilt by restore()
+    void freeze();
+    void discard();
+    void restore();
+    bool isFrozen() const;
+    bool isDiscarded() const;
+
+    // Coalesced and re-sent automatically whenever a new embed document loads
+    void setPlaybackRate(double rate);
+    void seek(double seconds);
+    PlayerBridge *bridge() const { return m_bridge; }
+
+    // Last state pushed by the embed frame
+    double position() const { return m_position; }
+    double playbackRate() const { return m_playbackRate; }
+    double bufferedUntil() const { return m_buffered; }
+    double duration() const { return m_duration; }
+    bool isPaused() const { return m_paused; }
+
+    bool isShellReady() const { return m_shellReady; }
+    QString videoId() const { return m_videoId; }
+
+    static bool isValidVideoId(const QString &videoId);
+
+    // Named, disk-backed profile shared by every player view so the player's
+    // JS/CSS stays cached across tabs and runs. Cookies are session-only.
+    static QWebEngineProfile *playerProfile();
+    // Explicit privacy cleanup: cookies, HTTP cache and visited links
+    static void clearPlayerData();
+
+    // Set by the pool so the next playerReady() can be attributed to a recycled or new view
+    void setRecycled(bool recycled) { m_recycled = recycled; }
+    bool isRecycled() const { return m_recycled; }
+
+signals:
+    void shellReady();
+    // Embed iframe finished loading; elapsedMs counts from loadVideo()
+    void playerReady(const QString &videoId, qint64 elapsedMs);
+    void stateChanged(double position, double rate, double buffered, double duration, bool paused);
+    // First frame rendered, timed from the load request; byte counts cover the
+    // embed frame's same-origin resources
+    void firstFrame(const QString &videoId, qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes);
+    void videoEnded();
+
+private slots:
+    void onLoadFinished(bool ok);
+    void onBridgeReady(const QString &videoId);
+    void onBridgeState(double position, double rate, double buffered, double duration, bool paused);
+    void onBridgeFirstFrame(qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes);
+
+private:
+    static QString shellHtml();
+    static QString embedControlScript();
+    static QString webChannelScript();
+
+    PlayerBridge *m_bridge;
+    bool m_shellReady = false;
+    bool m_shellLoading = false;
+    QString m_videoId;
+    QString m_pendingVideoId;
+    QString m_preloadedVideoId;
+    double m_pendingStart = 0;
+    double m_position = 0;
+    double m_playbackRate = 1.0;
+    double m_buffered = 0;
+    double m_duration = 0;
+    bool m_paused = true;
+    bool m_restoring = false;
+    QElapsedTimer m_readyClock;
+    QElapsedTimer m_frameClock;
+    quint64 m_readyTraceId = 0;
+    bool m_prefetched = false;
+    bool m_recycled = false;
+};
@@ -0,0 +1,145 @@
+#include "PlayerViewPool.h"
+#include "../backend/Log.h"
+#include "../backend/Metrics.h"
+#include "PlayerView.h"
+#include <QSettings>
+#include <algorithm>
+
+void PlayerViewPool::TimingStats::record(qint64 ms) {
+    if (count == 0 || ms < bestMs) bestMs = ms;
+    if (ms > worstMs) worstMs = ms;
+    count++;
+    totalMs += ms;
+}
+
+PlayerViewPool::PlayerViewPool(QObject *parent) : QObject(parent) {
+    QSettings settings("YouCpp", "YouCpp");
+    m_maxIdle = std::max(1, settings.value("player/poolSize", 2).toInt());
+}
+
+PlayerViewPool::~PlayerViewPool() {
+    qDeleteAll(m_idleViews);
+}
+
+PlayerView *PlayerViewPool::createView() {
+    PlayerView *view = new PlayerView();
+    connect(view, &PlayerView::playerReady, this, &PlayerViewPool::onPlayerReady);
+    connect(view, &PlayerView::firstFrame, this, &PlayerViewPool::onFirstFrame);
+    return view;
+}
+
+void PlayerViewPool::prewarm() {
+    if (!m_idleViews.isEmpty()) return;
+
+    LOG_INFO("PlayerViewPool", "Pre-warming player view");
+
+    PlayerView *view = createView();
+    view->loadShell();
+    m_idleViews.append(view);
+}
+
+PlayerView *PlayerViewPool::acquire(QWidget *parent, const QString &videoId) {
+    PlayerView *view;
+    if (!m_idleViews.isEmpty()) {
+        int index = m_idleViews.size() - 1;
+        for (int i = 0; i < m_idleViews.size(); ++i) {
+            if (!videoId.isEmpty() && m_idleViews[i]->preloadedVideoId() == videoId) {
+                index = i;
+                break;
+            }
+        }
+        view = m_idleViews.takeAt(index);
+        view->setRecycled(true);
+        if (view->preloadedVideoId() != videoId) {
+            view->cancelPreload();
+        }
+    } else {
+        view = createView();
+        view->setRecycled(false);
+    }
+
+    view->setParent(parent);
+    return view;
+}
+
+void PlayerViewPool::prefetch(const QString &videoId) {
+    if (!PlayerView::isValidVideoId(videoId)) return;
+
+    if (m_idleViews.isEmpty()) {
+        prewarm();
+    }
+
+    // One speculative load at a time, in the view acquire() hands out next
+    for (int i = 0; i < m_idleViews.size() - 1; ++i) {
+        m_idleViews[i]->cancelPreload();
+    }
+    m_idleViews.last()->preloadVideo(videoId);
+}
+
+void PlayerViewPool::cancelPrefetch() {
+    for (PlayerView *view : m_idleViews) {
+        view->cancelPreload();
+    }
+}
+
+void PlayerViewPool::release(PlayerView *view) {
+    if (!view) return;
+
+    if (view->isFrozen()) {
+        view->restore();
+    }
+    view->stop();
+    view->resetForReuse();
+    view->hide();
+    view->setParent(nullptr);
+
+    if (m_idleViews.size() < m_maxIdle && view->isShellReady() && !view->isDiscarded()) {
+        m_idleViews.append(view);
+    } else {
+        view->deleteLater();
+    }
+}
+
+void PlayerViewPool::onPlayerReady(const QString &videoId, qint64 elapsedMs) {
+    PlayerView *view = qobject_cast<PlayerView *>(sender());
+    bool recycled = view && view->isRecycled();
+
+    TimingStats &stats = recycled ? m_recycledStats : m_freshStats;
+    stats.record(elapsedMs);
+    static Metrics::Histogram &readyMs = Metrics::histogram("player.ready_ms");
+    readyMs.record(elapsedMs);
+
+    LOG_INFO("PlayerViewPool", "Player ready for %s in %lld ms (%s view, avg %lld ms over %d)", videoId, (long long)elapsedMs, recycled ? "pooled" : "fresh",
+           (long long)stats.averageMs(), stats.count);
+}
+
+void PlayerViewPool::onFirstFrame(const QString &videoId, qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes) {
+    m_networkBytes += networkBytes;
+    m_cachedBytes += cachedBytes;
+    // Hit rate by bytes: the player's assets from the profile's HTTP cache vs the network
+    static Metrics::Counter &cacheHitBytes = Metrics::counter("cache.player_http_bytes.hits");
+    static Metrics::Counter &cacheMissBytes = Metrics::counter("cache.player_http_bytes.misses");
+    static Metrics::Histogram &firstFrameMs = Metrics::histogram("player.first_frame_ms");
+    cacheHitBytes.add(cachedBytes);
+    cacheMissBytes.add(networkBytes);
+    firstFrameMs.record(ttffMs);
+
+    // "Warm" means most of the player's own assets were served from the profile's disk cache
+    bool warm = cachedBytes > networkBytes;
+    TimingStats &stats = warm ? m_warmCacheTtff : m_coldCacheTtff;
+    stats.record(ttffMs);
+
+    PlayerView *view = qobject_cast<PlayerView *>(sender());
+    bool prefetched = view && view->wasPrefetched();
+    (prefetched ? m_prefetchedTtff : m_directTtff).record(ttffMs);
+
+    LOG_INFO("PlayerViewPool", "First frame for %s in %lld ms (%s cache%s): %.1f KB fetched, %.1f KB from cache", videoId, (long long)ttffMs, warm ? "warm" : "cold",
+           prefetched ? ", prefetched" : "", networkBytes / 1024.0, cachedBytes / 1024.0);
+    if (m_prefetchedTtff.count > 0 && m_directTtff.count > 0) {
+        LOG_INFO("PlayerViewPool", "Hover prefetch: avg %lld ms vs %lld ms without", (long long)m_prefetchedTtff.averageMs(), (long long)m_directTtff.averageMs());
+    }
+    if (m_warmCacheTtff.count > 0 && m_coldCacheTtff.count > 0) {
+        LOG_INFO("PlayerViewPool", "Cache saves ~%lld ms per first frame; %.1f MB served from cache so far", (long long)(m_coldCacheTtff.averageMs() - m_warmCacheTtff.averageMs()),
+               m_cachedBytes / (1024.0 * 1024.0));
+    }
+}
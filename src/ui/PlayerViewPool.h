@@ -0,0 +1,74 @@
+#pragma once
+#include <QObject>
+#include <QList>
+
+class PlayerView;
+class QWidget;
+
+// Hands out player views and takes them back when a tab closes, so opening
+// and closing videos reuses pages (and their renderers) instead of churning
+// them. Nothing here touches WebEngine until the first prewarm() or acquire(),
+// so Chromium stays out of the startup path.
+class PlayerViewPool : public QObject {
+    Q_OBJECT
+
+public:
+    struct TimingStats {
+        int count = 0;
+        qint64 totalMs = 0;
+        qint64 bestMs = 0;
+        qint64 worstMs = 0;
+
+        void record(qint64 ms);
+        qint64 averageMs() const { return count ? totalMs / count : 0; }
+    };
+
+    explicit PlayerViewPool(QObject *parent = nullptr);
+    ~PlayerViewPool();
+
+    // Creates one hidden view with the player shell loaded; no-op if one is idle
+    void prewarm();
+    // Prefers an idle view that has videoId prefetched
+    PlayerView *acquire(QWidget *parent, const QString &videoId = QString());
+    void release(PlayerView *view);
+
+    // Hover intent: load the embed for videoId hidden in an idle view
+    void prefetch(const QString &videoId);
+    void cancelPrefetch();
+
+    int idleCount() const { return m_idleViews.size(); }
+    int maxIdle() const { return m_maxIdle; }
+
+    // Time from loadVideo() to the embed iframe finishing its load
+    TimingStats recycledStats() const { return m_recycledStats; }
+    TimingStats freshStats() const { return m_freshStats; }
+
+    // Time to first frame split by whether the player assets came from the disk cache
+    TimingStats warmCacheTtff() const { return m_warmCacheTtff; }
+    TimingStats coldCacheTtff() const { return m_coldCacheTtff; }
+    qint64 networkBytes() const { return m_networkBytes; }
+    qint64 cachedBytes() const { return m_cachedBytes; }
+
+    // Click-to-first-frame with and without a hover prefetch
+    TimingStats prefetchedTtff() const { return m_prefetchedTtff; }
+    TimingStats directTtff() const { return m_directTtff; }
+
+private slots:
+    void onPlayerReady(const QString &videoId, qint64 elapsedMs);
+    void onFirstFrame(const QString &videoId, qint64 ttffMs, qint64 networkBytes, qint64 cachedBytes);
+
+private:
+    PlayerView *createView();
+
+    QList<PlayerView *> m_idleViews;
+    int m_maxIdle;
+
+    TimingStats m_recycledStats;
+    TimingStats m_freshStats;
+    TimingStats m_warmCacheTtff;
+    TimingStats m_coldCacheTtff;
+    TimingStats m_prefetchedTtff;
+    TimingStats m_directTtff;
+    qint64 m_networkBytes = 0;
+    qint64 m_cachedBytes = 0;
+};
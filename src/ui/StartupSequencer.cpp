@@ -0,0 +1,95 @@
+#include "StartupSequencer.h"
+#include "../backend/Log.h"
+#include "MainWindow.h"
+#include "../backend/GoogleAuth.h"
+#include "../backend/FeedSnapshot.h"
+#include "../backend/Trace.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QEvent>
+#include <QTimer>
+
+// Chromium is started off the startup path: a while after first paint, or sooner once the feed is in
+const int StartupSequencer::PLAYER_PREWARM_DELAY_MS = 3000;
+const int StartupSequencer::PLAYER_PREWARM_AFTER_FEED_MS = 500;
+
+StartupSequencer::StartupSequencer(const QElapsedTimer &processClock, bool traceEnabled, QObject *parent)
+    : QObject(parent)
+    , m_processClock(processClock)
+    , m_traceEnabled(traceEnabled)
+{
+    connect(&m_snapshotWatcher, &QFutureWatcher<QList<VideoResult>>::finished,
+            this, &StartupSequencer::onSnapshotLoaded);
+}
+
+void StartupSequencer::mark(const char *phase) {
+    Trace::instant("startup", phase);
+    if (!m_traceEnabled) return;
+
+    qint64 now = m_processClock.elapsed();
+    LOG_INFO("Startup", "%6lld ms  (+%5lld ms)  %s", (long long)now, (long long)(now - m_lastMarkMs), phase);
+    m_lastMarkMs = now;
+}
+
+MainWindow *StartupSequencer::start() {
+    // Network first: the token refresh runs on QNAM's own thread while the widgets are built
+    m_auth = new GoogleAuth();
+    m_service = new YouTubeService();
+    m_service->setAuth(m_auth);
+    m_auth->setCredentials(qEnvironmentVariable("GOOGLE_CLIENT_ID"),
+                           qEnvironmentVariable("GOOGLE_CLIENT_SECRET"));
+    mark(m_auth->isRefreshing() ? "auth loaded, token refresh in flight" : "auth loaded");
+
+    if (m_auth->isAuthenticated() || m_auth->isRefreshing()) {
+        m_snapshotWatcher.setFuture(QtConcurrent::run(&FeedSnapshot::load));
+        mark("feed snapshot load started");
+    }
+
+    m_window = new MainWindow(m_auth, m_service);
+    connect(m_window, &MainWindow::feedShown, this, &StartupSequencer::onFeedShown);
+    mark("MainWindow constructed");
+
+    m_window->installEventFilter(this);
+    m_window->show();
+    mark("MainWindow shown");
+
+    return m_window;
+}
+
+bool StartupSequencer::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == m_window && event->type() == QEvent::Paint && !m_firstPaintSeen) {
+        m_firstPaintSeen = true;
+        m_window->removeEventFilter(this);
+        mark("first paint");
+        QTimer::singleShot(PLAYER_PREWARM_DELAY_MS, this, &StartupSequencer::prewarmPlayer);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StartupSequencer::onSnapshotLoaded() {
+    QList<VideoResult> snapshot = m_snapshotWatcher.result();
+    mark(snapshot.isEmpty() ? "feed snapshot empty" : "feed snapshot loaded");
+
+    if (!snapshot.isEmpty()) {
+        m_window->showFeedSnapshot(snapshot);
+    }
+}
+
+void StartupSequencer::onFeedShown(int count, bool fromSnapshot) {
+    if (count > 0 && !m_firstCardSeen) {
+        m_firstCardSeen = true;
+        mark(fromSnapshot ? "first feed card (snapshot)" : "first feed card (network)");
+    }
+    if (!fromSnapshot) {
+        mark("network feed shown");
+        disconnect(m_window, &MainWindow::feedShown, this, &StartupSequencer::onFeedShown);
+        QTimer::singleShot(PLAYER_PREWARM_AFTER_FEED_MS, this, &StartupSequencer::prewarmPlayer);
+    }
+}
+
+void StartupSequencer::prewarmPlayer() {
+    if (m_playerPrewarmed) return;
+    m_playerPrewarmed = true;
+
+    m_window->prewarmPlayer();
+    mark("player view pre-warm started");
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QList>
+#include "../backend/YouTubeService.h"
+
+class GoogleAuth;
+class MainWindow;
+
+// Overlaps token refresh and feed snapshot loading with widget construction.
+// With --trace-startup every phase is printed relative to process start.
+class StartupSequencer : public QObject {
+    Q_OBJECT
+
+public:
+    StartupSequencer(const QElapsedTimer &processClock, bool traceEnabled, QObject *parent = nullptr);
+
+    // phase must be a string literal; it is also recorded as a trace instant
+    void mark(const char *phase);
+    MainWindow *start();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onSnapshotLoaded();
+    void onFeedShown(int count, bool fromSnapshot);
+    void prewarmPlayer();
+
+private:
+    QElapsedTimer m_processClock;
+    qint64 m_lastMarkMs = 0;
+    bool m_traceEnabled;
+
+    GoogleAuth *m_auth = nullptr;
+    YouTubeService *m_service = nullptr;
+    MainWindow *m_window = nullptr;
+    QFutureWatcher<QList<VideoResult>> m_snapshotWatcher;
+
+    bool m_firstPaintSeen = false;
+    bool m_firstCardSeen = false;
+    bool m_playerPrewarmed = false;
+
+    static const int PLAYER_PREWARM_DELAY_MS;
+    static const int PLAYER_PREWARM_AFTER_FEED_MS;
+};
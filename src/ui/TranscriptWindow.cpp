@@ -1,29 +1,71 @@
 #include "TranscriptWindow.h"
+#include "../backend/Log.h"
+#include "PlayerView.h"
+#include "PlayerBridge.h"
+#include "PlayerViewPool.h"
+#include "../backend/YouTubeService.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QWebEngineSettings>
-#include <QWebEngineProfile>
-#include <QWebEngineCookieStore>
-#include <QWebEngineHttpRequest>
 #include <QUrl>
+#include <QSettings>
+#include <QWebEnginePage>
+#include <QSplitter>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <numeric>
 
-TranscriptWindow::TranscriptWindow(const QString &videoId, const QString &title, QWidget *parent) 
+TranscriptWindow::TranscriptWindow(const QString &videoId, const QString &title, double startSeconds,
+                                   PlayerViewPool *pool, YouTubeService *service, QWidget *parent)
     : QWidget(parent) 
+    , m_pool(pool)
+    , m_service(service)
+    , m_videoId(videoId)
+    , m_title(title)
+    , m_freezeTimer(new QTimer(this))
+    , m_discardTimer(new QTimer(this))
 {
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
 
-    m_webView = new QWebEngineView(this);
-    m_webView->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
-    m_webView->settings()->setAttribute(QWebEngineSettings::PlaybackRequiresUserGesture, false);
-    
-    m_webView->page()->profile()->setHttpUserAgent("Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36");
-    m_webView->page()->profile()->cookieStore()->deleteAllCookies();
-    m_webView->page()->profile()->clearHttpCache();
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
+    splitter->setChildrenCollapsible(false);
+    layout->addWidget(splitter, 1);
+
+    m_webView = pool->acquire(splitter, videoId);
+    m_webView->loadVideo(videoId, startSeconds);
+    splitter->addWidget(m_webView);
+    splitter->addWidget(createTranscriptPanel());
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    connect(m_service, &YouTubeService::transcriptReady, this, &TranscriptWindow::onTranscriptReady);
+    connect(m_service, &YouTubeService::transcriptUnavailable, this, &TranscriptWindow::onTranscriptUnavailable);
+    connect(m_webView, &PlayerView::stateChanged, this, &TranscriptWindow::followPlayback);
+    connect(m_webView, &PlayerView::stateChanged, this, [this](double, double rate) {
+        m_autoBtn->setText(m_autoSpeed && m_webView->bridge()->hasSchedule()
+            ? QString("Auto %1x").arg(rate, 0, 'f', 1) : QString("Auto"));
+    });
+    connect(&m_scheduleWatcher, &QFutureWatcher<SpeedSchedule>::finished, this, &TranscriptWindow::onScheduleReady);
 
-    loadVideo(videoId);
-    layout->addWidget(m_webView, 1);
+    connect(m_webView, &PlayerView::videoEnded, this, &TranscriptWindow::playNext);
+    connect(m_webView, &PlayerView::playerReady, this, &TranscriptWindow::preloadNext);
+
+    // Background tabs: freeze the page shortly after it's hidden, discard it after a long idle
+    QSettings settings("YouCpp", "YouCpp");
+    bool showTranscript = settings.value("player/showTranscript", true).toBool();
+    bool autoSpeed = settings.value("player/autoSpeed", false).toBool();
+    int freezeAfterSecs = settings.value("player/freezeAfterSeconds", 15).toInt();
+    int discardAfterMins = settings.value("player/discardAfterMinutes", 10).toInt();
+
+    m_freezeTimer->setSingleShot(true);
+    m_freezeTimer->setInterval(std::max(freezeAfterSecs, 0) * 1000);
+    connect(m_freezeTimer, &QTimer::timeout, this, &TranscriptWindow::freezePlayer);
+
+    m_discardTimer->setSingleShot(true);
+    m_discardTimer->setInterval(std::max(discardAfterMins, 0) * 60 * 1000);
+    connect(m_discardTimer, &QTimer::timeout, this, &TranscriptWindow::hibernate);
+    m_discardEnabled = discardAfterMins > 0;
 
     QWidget *controlBar = new QWidget(this);
     controlBar->setObjectName("controlBar");
@@ -107,47 +149,368 @@ TranscriptWindow::TranscriptWindow(const QString &videoId, const QString &title,
     )");
     
     connect(m_speedSlider, &QSlider::valueChanged, this, &TranscriptWindow::updatePlaybackSpeed);
+
+    m_upNextLabel = new QLabel(this);
+    m_upNextLabel->setStyleSheet("font-size: 12px; color: #a6adc8;");
+    m_upNextLabel->setMaximumWidth(260);
+
+    m_skipBtn = new QPushButton("Next >>", this);
+    m_skipBtn->setFixedHeight(32);
+    m_skipBtn->setCursor(Qt::PointingHandCursor);
+    m_skipBtn->setToolTip("Play the next queued video");
+    m_skipBtn->setStyleSheet(R"(
+        QPushButton {
+            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
+                        stop:0 #313244, stop:1 #2a2a3c);
+            border: 1px solid #45475a;
+            border-radius: 6px;
+            color: #cdd6f4;
+            font-size: 11px;
+            font-weight: 600;
+            padding: 0 12px;
+        }
+        QPushButton:hover {
+            border: 1px solid #89b4fa;
+            color: #89b4fa;
+        }
+    )");
+    connect(m_skipBtn, &QPushButton::clicked, this, &TranscriptWindow::playNext);
+
+    m_transcriptBtn = new QPushButton("Transcript", this);
+    m_transcriptBtn->setCheckable(true);
+    m_transcriptBtn->setFixedHeight(32);
+    m_transcriptBtn->setCursor(Qt::PointingHandCursor);
+    m_transcriptBtn->setToolTip("Show or hide the searchable transcript");
+    m_transcriptBtn->setStyleSheet(m_skipBtn->styleSheet() + R"(
+        QPushButton:checked {
+            border: 1px solid #89b4fa;
+            color: #89b4fa;
+        }
+    )");
+    connect(m_transcriptBtn, &QPushButton::toggled, this, &TranscriptWindow::setTranscriptVisible);
+
+    m_autoBtn = new QPushButton("Auto", this);
+    m_autoBtn->setCheckable(true);
+    m_autoBtn->setFixedHeight(32);
+    m_autoBtn->setMinimumWidth(64);
+    m_autoBtn->setCursor(Qt::PointingHandCursor);
+    m_autoBtn->setToolTip("Adapt speed to the captions: faster through silence and slow speech");
+    m_autoBtn->setStyleSheet(m_transcriptBtn->styleSheet());
+    connect(m_autoBtn, &QPushButton::toggled, this, &TranscriptWindow::setAutoSpeed);
     
     controlLayout->addWidget(speedIcon);
     controlLayout->addWidget(speedTextLabel);
     controlLayout->addLayout(presetLayout);
     controlLayout->addWidget(m_speedSlider, 1);
     controlLayout->addWidget(m_speedLabel);
+    controlLayout->addWidget(m_autoBtn);
     controlLayout->addStretch();
+    controlLayout->addWidget(m_upNextLabel);
+    controlLayout->addWidget(m_skipBtn);
+    controlLayout->addWidget(m_transcriptBtn);
+    updateQueueUI();
     
     layout->addWidget(controlBar);
+
+    m_transcriptBtn->setChecked(showTranscript);
+    m_transcriptPanel->setVisible(showTranscript);
+    m_autoSpeed = autoSpeed;
+    m_autoBtn->setChecked(autoSpeed);
+    loadTranscript();
 }
 
 TranscriptWindow::~TranscriptWindow() {
+    // Hand the view back before child widgets are destroyed so its page survives for the next tab;
+    // release() takes it out of the splitter
     if (m_webView) {
-        m_webView->stop();
-        m_webView->setHtml(""); 
-        m_webView->deleteLater();
+        m_pool->release(m_webView);
+        m_webView = nullptr;
     }
 }
 
-void TranscriptWindow::loadVideo(const QString &videoId) {
-    QString html = QString(
-        "<!DOCTYPE html>"
-        "<html style='height:100%;width:100%;margin:0;padding:0;'>"
-        "<head>"
-            "<meta name='referrer' content='origin' />"
-            "<style>"
-                "html, body { height:100%; width:100%; margin:0; padding:0; overflow:hidden; background:#000; }"
-                "iframe { position:absolute; top:0; left:0; width:100%; height:100%; border:none; }"
-            "</style>"
-        "</head>"
-        "<body>"
-            "<iframe id='player' "
-            "src='https://www.youtube-nocookie.com/embed/%1?autoplay=1&enablejsapi=1&origin=https://www.youtube-nocookie.com&rel=0' "
-            "allow='autoplay; encrypted-media' allowfullscreen "
-            "referrerpolicy='origin'>"
-            "</iframe>"
-        "</body>"
-        "</html>"
-    ).arg(videoId);
-
-    m_webView->setHtml(html, QUrl("https://www.youtube-nocookie.com/"));
+void TranscriptWindow::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+
+    m_freezeTimer->stop();
+    m_discardTimer->stop();
+    if (m_webView->isDiscarded()) {
+        LOG_INFO("TranscriptWindow", "Restoring %s at %.0fs", m_videoId, m_webView->position());
+    }
+    m_webView->restore();
+}
+
+void TranscriptWindow::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+
+    m_freezeTimer->start();
+    if (m_discardEnabled) {
+        m_discardTimer->start();
+    }
+}
+
+void TranscriptWindow::freezePlayer() {
+    // Leave audible pages running; the user is probably listening in the background
+    if (m_webView->page()->recentlyAudible()) {
+        m_freezeTimer->start();
+        return;
+    }
+    m_webView->freeze();
+}
+
+void TranscriptWindow::hibernate() {
+    if (isVisible() || m_webView->isDiscarded()) return;
+    // Same rule as freezing: background listening outlives the idle timeout
+    if (isAudible()) {
+        if (m_discardEnabled) m_discardTimer->start();
+        return;
+    }
+
+    m_freezeTimer->stop();
+    m_discardTimer->stop();
+
+    LOG_INFO("TranscriptWindow", "Discarding background player for %s at %.0fs", m_videoId, m_webView->position());
+    m_webView->discard();
+}
+
+bool TranscriptWindow::isHibernating() const {
+    return m_webView->isDiscarded();
+}
+
+bool TranscriptWindow::isAudible() const {
+    return m_webView->page()->recentlyAudible();
+}
+
+qint64 TranscriptWindow::rendererPid() const {
+    return m_webView->page()->renderProcessPid();
+}
+
+void TranscriptWindow::enqueue(const QString &videoId, const QString &title) {
+    if (!PlayerView::isValidVideoId(videoId)) return;
+
+    m_queue.append({videoId, title});
+    updateQueueUI();
+    preloadNext();
+}
+
+void TranscriptWindow::playNext() {
+    if (m_queue.isEmpty()) return;
+
+    QueuedVideo next = m_queue.takeFirst();
+    m_videoId = next.id;
+    m_title = next.title;
+
+    // Same page, same bridge: the chosen speed is re-sent once the new video is ready
+    m_webView->advanceTo(next.id);
+    updateQueueUI();
+    loadTranscript();
+    emit currentVideoChanged(m_videoId, m_title);
+}
+
+void TranscriptWindow::preloadNext() {
+    if (m_queue.isEmpty()) return;
+    m_webView->preloadVideo(m_queue.first().id);
+}
+
+void TranscriptWindow::updateQueueUI() {
+    bool hasQueue = !m_queue.isEmpty();
+    m_upNextLabel->setVisible(hasQueue);
+    m_skipBtn->setVisible(hasQueue);
+    if (!hasQueue) return;
+
+    QString nextTitle = m_upNextLabel->fontMetrics().elidedText(m_queue.first().title, Qt::ElideRight, 180);
+    m_upNextLabel->setText(m_queue.size() > 1
+        ? QString("Up next: %1 (+%2)").arg(nextTitle).arg(m_queue.size() - 1)
+        : QString("Up next: %1").arg(nextTitle));
+    m_upNextLabel->setToolTip(m_queue.first().title);
+}
+
+QWidget* TranscriptWindow::createTranscriptPanel() {
+    m_transcriptPanel = new QWidget(this);
+    m_transcriptPanel->setObjectName("transcriptPanel");
+    m_transcriptPanel->setMinimumWidth(260);
+    m_transcriptPanel->setStyleSheet(R"(
+        QWidget#transcriptPanel {
+            background: #181825;
+            border-left: 1px solid #313244;
+        }
+    )");
+
+    QVBoxLayout *panelLayout = new QVBoxLayout(m_transcriptPanel);
+    panelLayout->setContentsMargins(12, 12, 12, 12);
+    panelLayout->setSpacing(8);
+
+    m_transcriptSearch = new QLineEdit(m_transcriptPanel);
+    m_transcriptSearch->setPlaceholderText("Search transcript...");
+    m_transcriptSearch->setClearButtonEnabled(true);
+    m_transcriptSearch->setEnabled(false);
+    connect(m_transcriptSearch, &QLineEdit::textChanged, this, &TranscriptWindow::searchTranscript);
+
+    m_transcriptStatus = new QLabel(m_transcriptPanel);
+    m_transcriptStatus->setStyleSheet("font-size: 12px; color: #a6adc8;");
+
+    m_transcriptList = new QListWidget(m_transcriptPanel);
+    m_transcriptList->setWordWrap(true);
+    m_transcriptList->setLayoutMode(QListView::Batched);
+    m_transcriptList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_transcriptList->setStyleSheet(R"(
+        QListWidget {
+            background: transparent;
+            border: none;
+            color: #cdd6f4;
+            font-size: 13px;
+        }
+        QListWidget::item {
+            padding: 6px 4px;
+            border-radius: 4px;
+        }
+        QListWidget::item:hover {
+            background: #313244;
+        }
+        QListWidget::item:selected {
+            background: #45475a;
+            color: #cdd6f4;
+        }
+    )");
+    connect(m_transcriptList, &QListWidget::itemClicked, this, &TranscriptWindow::seekToSegment);
+    connect(m_transcriptList, &QListWidget::itemActivated, this, &TranscriptWindow::seekToSegment);
+
+    panelLayout->addWidget(m_transcriptSearch);
+    panelLayout->addWidget(m_transcriptStatus);
+    panelLayout->addWidget(m_transcriptList, 1);
+    return m_transcriptPanel;
+}
+
+void TranscriptWindow::setTranscriptVisible(bool visible) {
+    m_transcriptPanel->setVisible(visible);
+    QSettings settings("YouCpp", "YouCpp");
+    settings.setValue("player/showTranscript", visible);
+}
+
+void TranscriptWindow::loadTranscript() {
+    m_transcript = Transcript();
+    m_currentSegment = -1;
+    m_transcriptList->clear();
+    m_transcriptSearch->clear();
+    m_transcriptSearch->setEnabled(false);
+    m_transcriptStatus->setText("Loading transcript...");
+    m_service->fetchTranscript(m_videoId);
+
+    // A cached timeline can apply before the captions arrive
+    m_schedule = SpeedSchedule();
+    updateSchedule();
+}
+
+void TranscriptWindow::onTranscriptReady(const QString &videoId, const Transcript &transcript) {
+    // Several tabs share the service; a queue advance may also have moved this one on
+    if (videoId != m_videoId || !m_transcript.isEmpty()) return;
+
+    m_transcript = transcript;
+    m_transcriptSearch->setEnabled(true);
+    searchTranscript(m_transcriptSearch->text());
+    updateSchedule();
+}
+
+void TranscriptWindow::onTranscriptUnavailable(const QString &videoId, const QString &reason) {
+    if (videoId != m_videoId || !m_transcript.isEmpty()) return;
+    m_transcriptStatus->setText(reason);
+}
+
+void TranscriptWindow::searchTranscript(const QString &query) {
+    if (m_transcript.isEmpty()) return;
+
+    if (query.trimmed().isEmpty()) {
+        QVector<int> all(m_transcript.size());
+        std::iota(all.begin(), all.end(), 0);
+        showSegments(all);
+        m_showingAllSegments = true;
+        m_transcriptStatus->setText(QString("%1 lines").arg(m_transcript.size()));
+        m_currentSegment = -1;
+        followPlayback(m_webView->position());
+        return;
+    }
+
+    QVector<int> hits = m_transcript.search(query);
+    showSegments(hits);
+    m_showingAllSegments = false;
+    m_transcriptStatus->setText(hits.size() == 1 ? QString("1 match") : QString("%1 matches").arg(hits.size()));
+}
+
+void TranscriptWindow::showSegments(const QVector<int> &segments) {
+    m_transcriptList->setUpdatesEnabled(false);
+    m_transcriptList->clear();
+    for (int index : segments) {
+        QListWidgetItem *item = new QListWidgetItem(
+            QString("%1  %2").arg(Transcript::formatTimestamp(m_transcript.startMs(index)), m_transcript.text(index)));
+        item->setData(Qt::UserRole, index);
+        m_transcriptList->addItem(item);
+    }
+    m_transcriptList->setUpdatesEnabled(true);
+}
+
+void TranscriptWindow::seekToSegment(QListWidgetItem *item) {
+    int index = item->data(Qt::UserRole).toInt();
+    m_webView->seek(m_transcript.startMs(index) / 1000.0);
+}
+
+void TranscriptWindow::followPlayback(double position) {
+    // Only the unfiltered list tracks the playhead; rows are segment indices there
+    if (!m_showingAllSegments || !m_transcriptPanel->isVisible()) return;
+
+    int segment = m_transcript.segmentAt(static_cast<qint64>(position * 1000));
+    if (segment == m_currentSegment || segment < 0) return;
+    m_currentSegment = segment;
+
+    m_transcriptList->setCurrentRow(segment);
+    if (!m_transcriptList->underMouse()) {
+        m_transcriptList->scrollToItem(m_transcriptList->item(segment), QAbstractItemView::PositionAtCenter);
+    }
+}
+
+void TranscriptWindow::setAutoSpeed(bool enabled) {
+    m_autoSpeed = enabled;
+    QSettings settings("YouCpp", "YouCpp");
+    settings.setValue("player/autoSpeed", enabled);
+
+    if (!enabled) {
+        m_webView->bridge()->setSchedule({});
+        m_autoBtn->setText("Auto");
+    } else if (!m_schedule.isEmpty()) {
+        m_webView->bridge()->setSchedule(m_schedule.toVariantList());
+    } else {
+        updateSchedule();
+    }
+}
+
+void TranscriptWindow::updateSchedule() {
+    if (!m_autoSpeed || !m_schedule.isEmpty() || m_scheduleWatcher.isRunning()) return;
+
+    QString videoId = m_videoId;
+    Transcript transcript = m_transcript;
+    m_scheduleVideoId = videoId;
+    m_scheduleWatcher.setFuture(QtConcurrent::run([videoId, transcript]() {
+        SpeedSchedule schedule = SpeedSchedule::load(videoId);
+        if (schedule.isEmpty() && !transcript.isEmpty()) {
+            schedule = SpeedSchedule::fromTranscript(transcript);
+            schedule.save(videoId);
+        }
+        return schedule;
+    }));
+}
+
+void TranscriptWindow::onScheduleReady() {
+    SpeedSchedule schedule = m_scheduleWatcher.result();
+
+    // The queue moved on, or captions arrived while only the cache was being checked
+    if (m_scheduleVideoId != m_videoId || (schedule.isEmpty() && !m_transcript.isEmpty())) {
+        updateSchedule();
+        return;
+    }
+    if (schedule.isEmpty()) return;
+
+    m_schedule = schedule;
+    if (m_autoSpeed) {
+        m_webView->bridge()->setSchedule(m_schedule.toVariantList());
+    }
 }
 
 void TranscriptWindow::updatePlaybackSpeed(int value) {
@@ -163,14 +526,9 @@ void TranscriptWindow::setSpeed(double speed) {
 }
 
 void TranscriptWindow::applySpeed(double speed) {
+    m_currentSpeed = speed;
     m_speedLabel->setText(QString("%1x").arg(speed, 0, 'f', 1));
-
-    QString js = QString(
-        "var v = document.querySelector('iframe').contentWindow.document.querySelector('video');"
-        "if(v) { v.playbackRate = %1; }"
-    ).arg(speed);
-    
-    m_webView->page()->runJavaScript(js);
+    m_webView->setPlaybackRate(speed);
 }
 
 QPushButton* TranscriptWindow::createSpeedButton(const QString &label, double speed) {
@@ -1,27 +1,107 @@
 #pragma once
 #include <QWidget>
-#include <QWebEngineView>
 #include <QSlider>
 #include <QLabel>
 #include <QPushButton>
+#include <QTimer>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QFutureWatcher>
+#include "../backend/Transcript.h"
+#include "../backend/SpeedSchedule.h"
+
+class PlayerView;
+class PlayerViewPool;
+class YouTubeService;
 
 class TranscriptWindow : public QWidget {
     Q_OBJECT
 
 public:
-    TranscriptWindow(const QString &videoId, const QString &title, QWidget *parent = nullptr);
+    TranscriptWindow(const QString &videoId, const QString &title, double startSeconds,
+                     PlayerViewPool *pool, YouTubeService *service, QWidget *parent = nullptr);
     ~TranscriptWindow();
 
+    QString videoId() const { return m_videoId; }
+    QString title() const { return m_title; }
+
+    // Queue mode: queued videos play in this tab's player, one after another
+    void enqueue(const QString &videoId, const QString &title);
+    int queuedCount() const { return m_queue.size(); }
+
+    // Discards the background player page now; it's rebuilt at the same position when shown
+    void hibernate();
+    bool isHibernating() const;
+    // Played sound in the last couple of seconds, e.g. music in a background tab
+    bool isAudible() const;
+    // 0 while the page has no live renderer (discarded or not yet started)
+    qint64 rendererPid() const;
+
+signals:
+    void currentVideoChanged(const QString &videoId, const QString &title);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
     void updatePlaybackSpeed(int value);
     void setSpeed(double speed);
+    void freezePlayer();
+    void playNext();
+    void preloadNext();
+    void onTranscriptReady(const QString &videoId, const Transcript &transcript);
+    void onTranscriptUnavailable(const QString &videoId, const QString &reason);
+    void searchTranscript(const QString &query);
+    void seekToSegment(QListWidgetItem *item);
+    void followPlayback(double position);
+    void setTranscriptVisible(bool visible);
+    void setAutoSpeed(bool enabled);
+    void onScheduleReady();
 
 private:
-    void loadVideo(const QString &videoId);
     void applySpeed(double speed);
     QPushButton* createSpeedButton(const QString &label, double speed);
+    void updateQueueUI();
+    QWidget* createTranscriptPanel();
+    void loadTranscript();
+    void showSegments(const QVector<int> &segments);
+    void updateSchedule();
+
+    struct QueuedVideo {
+        QString id;
+        QString title;
+    };
     
-    QWebEngineView *m_webView;
+    PlayerViewPool *m_pool;
+    YouTubeService *m_service;
+    PlayerView *m_webView;
+    QString m_videoId;
+    QString m_title;
+    double m_currentSpeed = 1.0;
+    QList<QueuedVideo> m_queue;
+
+    QTimer *m_freezeTimer;
+    QTimer *m_discardTimer;
+    bool m_discardEnabled;
     QLabel *m_speedLabel;
     QSlider *m_speedSlider;
+    QLabel *m_upNextLabel;
+    QPushButton *m_skipBtn;
+
+    Transcript m_transcript;
+    bool m_showingAllSegments = false;
+    int m_currentSegment = -1;
+    QWidget *m_transcriptPanel;
+    QLineEdit *m_transcriptSearch;
+    QLabel *m_transcriptStatus;
+    QListWidget *m_transcriptList;
+    QPushButton *m_transcriptBtn;
+
+    // Adaptive speed: caption-derived timeline, built (or read from cache) on a worker
+    SpeedSchedule m_schedule;
+    QString m_scheduleVideoId;
+    QFutureWatcher<SpeedSchedule> m_scheduleWatcher;
+    bool m_autoSpeed = false;
+    QPushButton *m_autoBtn;
 };
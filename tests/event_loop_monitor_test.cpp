@@ -0,0 +1,72 @@
+// EventLoopMonitor under a MonitoredApplication: stalls are recorded and attributed, including
+// when the dispatch deletes its own receiver
+#include "../src/ui/EventLoopMonitor.h"
+#include <QPointer>
+#include <QTest>
+#include <QThread>
+
+namespace {
+
+// Longer than a frame to tear down, so its DeferredDelete is a stall
+class SlowToDestroy : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SlowToDestroy(QObject *parent = nullptr) : QObject(parent) {
+        setObjectName("player");
+    }
+    ~SlowToDestroy() override { QThread::msleep(EventLoopMonitor::STALL_THRESHOLD_MS * 3); }
+};
+
+}
+
+class EventLoopMonitorTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init() {
+        QVERIFY(EventLoopMonitor::instance());
+        EventLoopMonitor::instance()->reset();
+    }
+
+    void fastDispatchIsNotAStall() {
+        QObject receiver;
+        QCoreApplication::postEvent(&receiver, new QEvent(QEvent::User));
+        QCoreApplication::sendPostedEvents(&receiver, QEvent::User);
+        QCOMPARE(EventLoopMonitor::instance()->stallCount(), 0);
+    }
+
+    void deleteLaterOfSlowObjectIsAttributedToItsClass() {
+        EventLoopMonitor *monitor = EventLoopMonitor::instance();
+        QPointer<QObject> object = new SlowToDestroy;
+        object->deleteLater();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+        QVERIFY(object.isNull());
+        QCOMPARE(monitor->stallCount(), 1);
+        QList<EventLoopMonitor::Offender> offenders = monitor->worstOffenders(1);
+        QCOMPARE(offenders.size(), 1);
+        // Only the class name survives the receiver; its objectName and parent are gone
+        QCOMPARE(offenders[0].source, QString("SlowToDestroy DeferredDelete"));
+    }
+
+    void deleteLaterWithParentAlive() {
+        EventLoopMonitor *monitor = EventLoopMonitor::instance();
+        QObject owner;
+        QPointer<QObject> object = new SlowToDestroy(&owner);
+        object->deleteLater();
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+        QVERIFY(object.isNull());
+        QCOMPARE(monitor->stallCount(), 1);
+        QCOMPARE(monitor->worstOffenders(1).value(0).source, QString("SlowToDestroy DeferredDelete"));
+    }
+};
+
+int main(int argc, char *argv[]) {
+    MonitoredApplication app(argc, argv);
+    EventLoopMonitorTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "event_loop_monitor_test.moc"
@@ -0,0 +1,54 @@
+// Eviction order of PlayerMemoryBudget::pickVictims; no renderers involved
+#include "../src/ui/PlayerMemoryBudget.h"
+#include <QTest>
+
+namespace {
+
+const qint64 MB = 1024 * 1024;
+
+PlayerMemoryBudget::Candidate hiddenTab(qint64 megabytes) {
+    PlayerMemoryBudget::Candidate candidate;
+    candidate.bytes = megabytes * MB;
+    return candidate;
+}
+
+}
+
+class PlayerMemoryBudgetTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void underBudgetPicksNothing() {
+        QList<PlayerMemoryBudget::Candidate> tabs{hiddenTab(400), hiddenTab(400)};
+        QVERIFY(PlayerMemoryBudget::pickVictims(tabs, 800 * MB, 1000 * MB).isEmpty());
+    }
+
+    void leastRecentlyUsedGoesFirst() {
+        QList<PlayerMemoryBudget::Candidate> tabs{hiddenTab(400), hiddenTab(400), hiddenTab(400)};
+        QCOMPARE(PlayerMemoryBudget::pickVictims(tabs, 1200 * MB, 1000 * MB), QList<int>{0});
+    }
+
+    void skipsVisibleAndHibernatingTabs() {
+        QList<PlayerMemoryBudget::Candidate> tabs{hiddenTab(400), hiddenTab(0), hiddenTab(400), hiddenTab(400)};
+        tabs[0].visible = true;
+        tabs[2].hibernating = true;
+        QCOMPARE(PlayerMemoryBudget::pickVictims(tabs, 1200 * MB, 1000 * MB), QList<int>{3});
+    }
+
+    void sparesAudibleHiddenTab() {
+        // The oldest tab is playing music in the background; the next one pays instead
+        QList<PlayerMemoryBudget::Candidate> tabs{hiddenTab(500), hiddenTab(300), hiddenTab(300)};
+        tabs[0].audible = true;
+        QCOMPARE(PlayerMemoryBudget::pickVictims(tabs, 1100 * MB, 1000 * MB), QList<int>{1});
+    }
+
+    void onlyAudibleTabsLeftStaysOverBudget() {
+        QList<PlayerMemoryBudget::Candidate> tabs{hiddenTab(800), hiddenTab(800)};
+        tabs[0].audible = true;
+        tabs[1].visible = true;
+        QVERIFY(PlayerMemoryBudget::pickVictims(tabs, 1600 * MB, 1000 * MB).isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(PlayerMemoryBudgetTest)
+#include "player_memory_budget_test.moc"